@@ -0,0 +1,424 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <memory>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#include "counters.hpp"
+
+
+
+// the runtime all the benchmark mains share, instead of a Timer struct or a timeFunc in every
+// file timing one run with high_resolution_clock. For every kernel it does:
+//   - calibration: one call to see how long it takes, and then enough calls per trial that a
+//     trial takes at least --min-time (1 ms), so short kernels are way above the clock resolution
+//   - warmup trials (2), not timed, for the caches, the branch predictors and the clock frequency
+//   - timed trials (15), and min, p10, median, p90, max and mean of them. The median is the
+//     number to look at, p10 to p90 says how much it moves
+// and for the whole program:
+//   - pins the thread to a core with sched_setaffinity (the one it starts on, or --cpu), so it
+//     doesn't get moved around between trials and lose its caches
+//   - with --flush, writes over a buffer twice the size of the last level cache before every
+//     trial, so each trial starts with cold caches. That only makes sense with one call per
+//     trial, so --flush also turns off the calibration
+//   - --json file writes every result (with all the trials) to file, and --baseline file
+//     compares with a file written like that before: every kernel with the same name gets its
+//     change in median, and it only counts as faster or slower if the change is over
+//     --threshold (5%) AND the p10-p90 ranges of the two runs don't overlap. finish() returns 1
+//     if something got slower, so it can be the return value of main
+//   - hardware counters (counters.hpp) over the timed trials, so every result also has IPC,
+//     cache and dTLB miss rates and stalled cycles, which format() prints after the time. If
+//     the counters can't be opened (VM, perf_event_paranoid) the first line says why, and it's
+//     just the times. --no-counters turns them off
+//
+// usage, where items is the number of elements a call handles, for the per-element numbers:
+//   bench::suite suite("name", argc, argv);
+//   bench::result r = suite.run("exp2<5>", [&]() { vecmath::exp2<5>(in, out, N); }, N);
+//   std::printf("%s\n", bench::format(r).c_str());
+//   return suite.finish();
+
+namespace bench {
+
+struct config {
+	int warmup = 2;
+	int reps = 15;
+	double min_time_ms = 1.0;
+	int cpu = -1;          // -1: the one the program starts on
+	bool pin = true;
+	bool flush = false;
+	bool counters = true;
+	double threshold = 0.05;
+	std::string json;
+	std::string baseline;
+};
+
+struct result {
+	std::string name;
+	double items = 0;      // per call, 0 if the number doesn't mean anything
+	long calls = 0;        // per trial
+	std::vector<double> trials_ns; // per call, sorted
+	sample counts;                 // per call, over the timed trials
+
+	double min_ns = 0, p10_ns = 0, median_ns = 0, p90_ns = 0, max_ns = 0, mean_ns = 0;
+
+	double per_item(double ns) const { return items > 0 ? ns / items : ns; }
+	double spread() const { return median_ns > 0 ? (p90_ns - p10_ns) / median_ns : 0.0; }
+};
+
+// keeps a value the compiler would otherwise see as unused (and drop the code computing it)
+template <typename T>
+inline void keep(const T& value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+
+
+namespace detail {
+
+// linear interpolation between the closest trials, sorted has to be sorted
+inline double percentile(const std::vector<double>& sorted, double p) {
+	if (sorted.empty()) return 0.0;
+	double k = p * (sorted.size() - 1);
+	size_t i = static_cast<size_t>(k);
+	if (i + 1 >= sorted.size()) return sorted.back();
+	return sorted[i] + (k - i) * (sorted[i + 1] - sorted[i]);
+}
+
+// the biggest cache sysfs knows about, 32 MB if it doesn't say
+inline size_t last_level_cache() {
+	size_t biggest = 0;
+	for (int i = 0; i < 8; ++i) {
+		std::ifstream f("/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(i) + "/size");
+		std::string s;
+		if (!(f >> s)) break;
+		size_t size = std::strtoull(s.c_str(), nullptr, 10);
+		if (s.back() == 'K') size <<= 10;
+		else if (s.back() == 'M') size <<= 20;
+		biggest = std::max(biggest, size);
+	}
+	return biggest ? biggest : (32u << 20);
+}
+
+inline std::string escape(const std::string& s) {
+	std::string out;
+	for (char c : s) {
+		if (c == '"' || c == '\\') out += '\\';
+		out += c;
+	}
+	return out;
+}
+
+// only reads what write_json writes: the objects of "results", with their name, median, p10 and p90
+inline std::vector<result> read_json(const std::string& path, std::string& suite_name) {
+	std::ifstream f(path);
+	std::string text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	std::vector<result> results;
+
+	auto read_string = [&](size_t i) {
+		std::string s;
+		for (++i; i < text.size() && text[i] != '"'; ++i) {
+			if (text[i] == '\\') ++i;
+			s += text[i];
+		}
+		return s;
+	};
+
+	// position of the value of "key" in [begin, end), or npos
+	auto find_value = [&](const char* key, size_t begin, size_t end) {
+		size_t i = text.find(std::string("\"") + key + "\":", begin);
+		if (i == std::string::npos || i >= end) return std::string::npos;
+		i = text.find(':', i) + 1;
+		while (i < end && text[i] == ' ') ++i;
+		return i;
+	};
+
+	size_t i = find_value("suite", 0, text.size());
+	if (i != std::string::npos) suite_name = read_string(i);
+
+	size_t pos = text.find("\"results\"");
+	while (pos != std::string::npos) {
+		size_t begin = text.find('{', pos);
+		if (begin == std::string::npos) break;
+
+		// the end of the object, skipping over the strings (names can have braces in them)
+		size_t end = begin + 1;
+		for (; end < text.size() && text[end] != '}'; ++end) {
+			if (text[end] == '"') for (++end; end < text.size() && text[end] != '"'; ++end) if (text[end] == '\\') ++end;
+		}
+
+		result r;
+		size_t v = find_value("name", begin, end);
+		if (v != std::string::npos) {
+			r.name = read_string(v);
+			if ((v = find_value("median_ns", begin, end)) != std::string::npos) r.median_ns = std::strtod(text.c_str() + v, nullptr);
+			if ((v = find_value("p10_ns", begin, end)) != std::string::npos) r.p10_ns = std::strtod(text.c_str() + v, nullptr);
+			if ((v = find_value("p90_ns", begin, end)) != std::string::npos) r.p90_ns = std::strtod(text.c_str() + v, nullptr);
+			results.push_back(r);
+		}
+		pos = end;
+	}
+
+	return results;
+}
+
+}
+
+
+
+// for mains with options of their own that pass the rest on to suite: whether arg is one of
+// the suite's options that take a value, so the argument after it goes along too
+inline bool takes_value(const std::string& arg) {
+	for (const char* option : { "--warmup", "--reps", "--min-time", "--cpu", "--json", "--baseline", "--threshold" }) {
+		if (arg == option) return true;
+	}
+	return false;
+}
+
+
+
+// "8.123 ns/element +-1.2%" with items, "1.234 ms +-1.2%" without: the median per item (or per
+// call), and half the p10-p90 range relative to it
+inline std::string format(const result& r, const char* unit = "element") {
+	char buf[96];
+	if (r.items > 0) std::snprintf(buf, sizeof(buf), "%9.3f ns/%s +-%.1f%%", r.per_item(r.median_ns), unit, 50.0 * r.spread());
+	else std::snprintf(buf, sizeof(buf), "%9.3f ms +-%.1f%%", r.median_ns * 1e-6, 50.0 * r.spread());
+
+	std::string counts = format(r.counts);
+	return counts.empty() ? std::string(buf) : std::string(buf) + "   " + counts;
+}
+
+
+
+class suite {
+public:
+	suite(const char* name, int argc, char** argv, config defaults = {}) : name(name), cfg(defaults) {
+		parse(argc, argv);
+
+		std::string where = "not pinned";
+#ifdef __linux__
+		if (cfg.pin) {
+			if (cfg.cpu < 0) cfg.cpu = sched_getcpu();
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(cfg.cpu, &set);
+			if (sched_setaffinity(0, sizeof(set), &set) == 0) where = "pinned to cpu " + std::to_string(cfg.cpu);
+			else std::fprintf(stderr, "bench: couldn't pin to cpu %d (%s), running anywhere\n", cfg.cpu, std::strerror(errno));
+		}
+#endif
+
+		if (cfg.flush) flush_buffer.resize(2 * detail::last_level_cache());
+
+		std::string counting = "no counters";
+		if (cfg.counters) {
+			pmu = std::make_unique<counters>();
+			counting = pmu->available() ? "counters on" : "no counters: " + pmu->error();
+		}
+
+		std::printf("[%s: %s, %d reps after %d warmup, %s, %s]\n", name, where.c_str(), cfg.reps, cfg.warmup,
+			cfg.flush ? ("caches flushed (" + std::to_string(flush_buffer.size() >> 20) + " MB)").c_str() : "caches warm", counting.c_str());
+	}
+
+	const config& settings() const { return cfg; }
+
+	// times f(), which should do the same work every call. items is how many elements one call
+	// handles (for the per-element numbers), or 0
+	template <typename F>
+	result run(const std::string& kernel, F&& f, double items = 0) {
+		result r;
+		r.name = kernel;
+		r.items = items;
+
+		// calibration, which also counts as the first warmup call
+		if (cfg.flush) flush();
+		double first = time(f, 1);
+		r.calls = 1;
+		if (!cfg.flush && first < cfg.min_time_ms * 1e6) {
+			r.calls = static_cast<long>(std::ceil(cfg.min_time_ms * 1e6 / std::max(first, 1.0)));
+		}
+
+		for (int w = 0; w < cfg.warmup; ++w) {
+			if (cfg.flush) flush();
+			time(f, r.calls);
+		}
+
+		// the counters only run around the timed calls, not the flushes
+		if (pmu) pmu->reset();
+		for (int t = 0; t < cfg.reps; ++t) {
+			if (cfg.flush) flush();
+			if (pmu) pmu->start();
+			r.trials_ns.push_back(time(f, r.calls) / r.calls);
+			if (pmu) pmu->stop();
+		}
+		if (pmu) r.counts = pmu->read().per(static_cast<double>(cfg.reps) * r.calls);
+
+		std::sort(r.trials_ns.begin(), r.trials_ns.end());
+		r.min_ns = r.trials_ns.front();
+		r.max_ns = r.trials_ns.back();
+		r.p10_ns = detail::percentile(r.trials_ns, 0.1);
+		r.median_ns = detail::percentile(r.trials_ns, 0.5);
+		r.p90_ns = detail::percentile(r.trials_ns, 0.9);
+		for (double t : r.trials_ns) r.mean_ns += t / r.trials_ns.size();
+
+		results.push_back(r);
+		return r;
+	}
+
+	// writes the json and compares with the baseline, if they were asked for. 1 if anything
+	// got slower than the baseline, 0 otherwise
+	int finish() {
+		if (finished) return status;
+		finished = true;
+
+		if (!cfg.json.empty()) write_json(cfg.json);
+		if (!cfg.baseline.empty()) status = compare(cfg.baseline);
+		return status;
+	}
+
+	~suite() {
+		finish();
+	}
+
+private:
+	void parse(int argc, char** argv) {
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			auto value = [&]() -> const char* {
+				if (i + 1 >= argc) usage(argv[0], ("missing value for " + arg).c_str());
+				return argv[++i];
+			};
+
+			if (arg == "--warmup") cfg.warmup = std::atoi(value());
+			else if (arg == "--reps") cfg.reps = std::max(1, std::atoi(value()));
+			else if (arg == "--min-time") cfg.min_time_ms = std::atof(value());
+			else if (arg == "--cpu") { cfg.cpu = std::atoi(value()); cfg.pin = true; }
+			else if (arg == "--no-pin") cfg.pin = false;
+			else if (arg == "--flush") cfg.flush = true;
+			else if (arg == "--no-flush") cfg.flush = false;
+			else if (arg == "--no-counters") cfg.counters = false;
+			else if (arg == "--json") cfg.json = value();
+			else if (arg == "--baseline") cfg.baseline = value();
+			else if (arg == "--threshold") cfg.threshold = std::atof(value()) / 100.0;
+			else if (arg == "--help" || arg == "-h") usage(argv[0], nullptr);
+			else usage(argv[0], ("unknown option " + arg).c_str());
+		}
+	}
+
+	[[noreturn]] void usage(const char* program, const char* error) const {
+		if (error) std::fprintf(stderr, "%s\n", error);
+		std::fprintf(error ? stderr : stdout,
+			"usage: %s [options]\n"
+			"  --warmup n        untimed trials before the timed ones (%d)\n"
+			"  --reps n          timed trials (%d)\n"
+			"  --min-time ms     shortest trial, short kernels get called more times per trial (%g)\n"
+			"  --cpu k           pin to cpu k (default: the one it starts on)\n"
+			"  --no-pin          don't pin\n"
+			"  --flush, --no-flush  flush the caches before every trial, one call per trial (%s)\n"
+			"  --json file       write the results to file\n"
+			"  --baseline file   compare with the results in file (from --json)\n"
+			"  --threshold pct   smallest change that counts, in %% (%g)\n"
+			"  --no-counters     don't open the hardware counters\n",
+			program, cfg.warmup, cfg.reps, cfg.min_time_ms, cfg.flush ? "on" : "off", cfg.threshold * 100.0);
+		std::exit(error ? 1 : 0);
+	}
+
+	template <typename F>
+	static double time(F& f, long calls) {
+		auto start = std::chrono::steady_clock::now();
+		for (long c = 0; c < calls; ++c) f();
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count();
+	}
+
+	// writes every line of the buffer, which evicts everything else (dirty lines included)
+	void flush() {
+		for (size_t i = 0; i < flush_buffer.size(); i += 64) flush_buffer[i] += 1;
+		keep(flush_buffer[flush_buffer.size() / 2]);
+	}
+
+	void write_json(const std::string& path) const {
+		std::ofstream f(path);
+		if (!f) {
+			std::fprintf(stderr, "bench: couldn't write %s\n", path.c_str());
+			return;
+		}
+
+		f.precision(9);
+		f << "{\n";
+		f << "  \"suite\": \"" << detail::escape(name) << "\",\n";
+		f << "  \"cpu\": " << (cfg.pin ? cfg.cpu : -1) << ",\n";
+		f << "  \"warmup\": " << cfg.warmup << ",\n";
+		f << "  \"reps\": " << cfg.reps << ",\n";
+		f << "  \"flush\": " << (cfg.flush ? "true" : "false") << ",\n";
+		f << "  \"results\": [\n";
+		for (size_t i = 0; i < results.size(); ++i) {
+			const result& r = results[i];
+			f << "    { \"name\": \"" << detail::escape(r.name) << "\", \"items\": " << r.items << ", \"calls\": " << r.calls
+				<< ", \"min_ns\": " << r.min_ns << ", \"p10_ns\": " << r.p10_ns << ", \"median_ns\": " << r.median_ns
+				<< ", \"p90_ns\": " << r.p90_ns << ", \"max_ns\": " << r.max_ns << ", \"mean_ns\": " << r.mean_ns
+				<< ", \"trials_ns\": [";
+			for (size_t t = 0; t < r.trials_ns.size(); ++t) f << (t ? ", " : "") << r.trials_ns[t];
+			f << "]";
+			// per call, only the ones that were counted
+			for (int e = 0; e < event_count; ++e) if (r.counts.valid[e]) f << ", \"" << event_name(e) << "\": " << r.counts.value[e];
+			f << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+		}
+		f << "  ]\n}\n";
+	}
+
+	int compare(const std::string& path) const {
+		std::string baseline_suite;
+		std::vector<result> baseline = detail::read_json(path, baseline_suite);
+		if (baseline.empty()) {
+			std::fprintf(stderr, "bench: nothing to compare in %s\n", path.c_str());
+			return 0;
+		}
+		if (baseline_suite != name) std::fprintf(stderr, "bench: %s is from %s, not %s\n", path.c_str(), baseline_suite.c_str(), name.c_str());
+
+		int slower = 0, faster = 0;
+		std::printf("\nagainst %s (median per call, change over %g%% with no p10-p90 overlap counts):\n", path.c_str(), cfg.threshold * 100.0);
+		for (const result& r : results) {
+			auto b = std::find_if(baseline.begin(), baseline.end(), [&](const result& b) { return b.name == r.name; });
+			if (b == baseline.end()) {
+				std::printf("  %-40s %12s %12.1f ns   new\n", r.name.c_str(), "", r.median_ns);
+				continue;
+			}
+
+			double change = r.median_ns / b->median_ns - 1.0;
+			bool overlap = r.p10_ns <= b->p90_ns && b->p10_ns <= r.p90_ns;
+			const char* verdict = "same";
+			if (std::abs(change) > cfg.threshold && !overlap) {
+				verdict = change > 0 ? "SLOWER" : "faster";
+				++(change > 0 ? slower : faster);
+			}
+			std::printf("  %-40s %12.1f %12.1f ns %+7.1f%%   %s\n", r.name.c_str(), b->median_ns, r.median_ns, 100.0 * change, verdict);
+		}
+		std::printf("%d faster, %d slower\n", faster, slower);
+
+		return slower ? 1 : 0;
+	}
+
+	std::string name;
+	config cfg;
+	std::vector<result> results;
+	std::vector<char> flush_buffer;
+	std::unique_ptr<counters> pmu;
+	bool finished = false;
+	int status = 0;
+};
+
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <cmath>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+
+// hardware performance counters around a piece of code, with perf_event_open (what perf stat
+// uses), for when the time alone doesn't say why: cycles and instructions (so IPC), L1D and
+// last level cache misses, dTLB misses and stalled cycles, plus page faults and context
+// switches, which are software events and work everywhere.
+//
+//   bench::counters c;
+//   { bench::region r(c); kernel(); }   // counts from here to the end of the scope
+//   bench::sample s = c.read();         // everything since the last reset()
+//
+// only user space gets counted (exclude_kernel), which is allowed with the default
+// perf_event_paranoid of 2. Whatever doesn't open just isn't there: no PMU in a VM, stalled
+// cycles on most Intel cores, paranoid 3, not Linux. A sample knows which values it has, and
+// the ratios of the missing ones are NaN. When the CPU has fewer counters than events they get
+// multiplexed, and the values are scaled by the time they were really counting, like perf stat
+// does. The events that get divided by each other are opened as a group (cycles, instructions
+// and stalled cycles; L1D loads, L1D misses and dTLB misses; LLC references and misses), which
+// the kernel only ever schedules all at once, so a ratio comes from the same window of time
+// and not from two different guesses of the whole run
+
+namespace bench {
+
+enum event {
+	cycles,
+	instructions,
+	stalled_cycles,  // backend, or frontend if the CPU doesn't have that
+	l1d_loads,
+	l1d_misses,
+	llc_references,
+	llc_misses,
+	dtlb_misses,     // loads
+	page_faults,
+	context_switches,
+	event_count
+};
+
+inline const char* event_name(int e) {
+	static const char* names[] = { "cycles", "instructions", "stalled_cycles", "l1d_loads", "l1d_misses", "llc_references", "llc_misses", "dtlb_misses", "page_faults", "context_switches" };
+	return names[e];
+}
+
+struct sample {
+	double value[event_count] = {};
+	bool valid[event_count] = {};
+
+	bool has(event e) const { return valid[e]; }
+	bool empty() const {
+		for (bool v : valid) if (v) return false;
+		return true;
+	}
+
+	double ratio(event a, event b) const {
+		return (valid[a] && valid[b] && value[b] > 0) ? value[a] / value[b] : NAN;
+	}
+
+	double ipc() const { return ratio(instructions, cycles); }
+	double l1d_miss_rate() const { return ratio(l1d_misses, l1d_loads); }
+	double llc_miss_rate() const { return ratio(llc_misses, llc_references); }
+	double dtlb_miss_rate() const { return ratio(dtlb_misses, l1d_loads); }
+	double stall_rate() const { return ratio(stalled_cycles, cycles); }
+
+	// every value divided by n, for counts per call or per element
+	sample per(double n) const {
+		sample s = *this;
+		for (double& v : s.value) v /= n;
+		return s;
+	}
+};
+
+class counters {
+public:
+	counters() {
+#ifdef __linux__
+		auto cache = [](uint64_t cache, uint64_t result) {
+			return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+		};
+
+		// the leader of each group, -1 until one of its events opens. The events of a group
+		// have to be added in the order of the enum, read() counts on it
+		int core = -1, l1d = -1, llc = -1, faults = -1, switches = -1;
+
+		add(cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, core);
+		add(instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, core);
+		if (!add(stalled_cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND, core)) {
+			add(stalled_cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND, core);
+		}
+		add(l1d_loads, PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_ACCESS), l1d);
+		add(l1d_misses, PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS), l1d);
+		add(dtlb_misses, PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS), l1d);
+		add(llc_references, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, llc);
+		add(llc_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, llc);
+		add(page_faults, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, faults);
+		add(context_switches, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, switches);
+#else
+		first_error = "not Linux";
+#endif
+	}
+
+	~counters() {
+#ifdef __linux__
+		for (int f : fd) if (f >= 0) close(f);
+#endif
+	}
+
+	counters(const counters&) = delete;
+	counters& operator=(const counters&) = delete;
+
+	// at least one hardware event, the software ones alone don't explain much
+	bool available() const {
+		for (int e = cycles; e <= dtlb_misses; ++e) if (fd[e] >= 0) return true;
+		return false;
+	}
+
+	// why the first hardware event that didn't open didn't
+	const std::string& error() const { return first_error; }
+
+	void start() {
+#ifdef __linux__
+		for (int e = 0; e < event_count; ++e) if (leader[e] == e) ioctl(fd[e], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+	}
+
+	void stop() {
+#ifdef __linux__
+		for (int e = 0; e < event_count; ++e) if (leader[e] == e) ioctl(fd[e], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#endif
+	}
+
+	void reset() {
+#ifdef __linux__
+		for (int e = 0; e < event_count; ++e) if (leader[e] == e) ioctl(fd[e], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+#endif
+	}
+
+	// the counts since the last reset, scaled for the multiplexing
+	sample read() const {
+		sample s;
+#ifdef __linux__
+		for (int l = 0; l < event_count; ++l) {
+			if (leader[l] != l) continue;
+
+			// number of events, time enabled, time running, then the values in the order the
+			// events were opened. The whole group shares the times, so it's scaled all the same
+			uint64_t v[3 + event_count];
+			ssize_t got = ::read(fd[l], v, sizeof(v));
+			if (got < static_cast<ssize_t>(3 * sizeof(uint64_t))) continue;
+			if (v[2] == 0 && v[1] > 0) continue; // never got the counters
+			double scale = (v[2] > 0 && v[2] < v[1]) ? static_cast<double>(v[1]) / v[2] : 1.0;
+
+			uint64_t i = 0;
+			for (int e = l; e < event_count && i < v[0]; ++e) {
+				if (leader[e] != l) continue;
+				s.valid[e] = true;
+				s.value[e] = static_cast<double>(v[3 + i++]) * scale;
+			}
+		}
+#endif
+		return s;
+	}
+
+private:
+#ifdef __linux__
+	// opens e in the group whose leader is lead, or as the leader if there isn't one yet. If the
+	// kernel won't take it in the group (more events than it could ever count at once) it gets
+	// opened by itself: still counted, only not in step with the others
+	bool add(event e, uint32_t type, uint64_t config, int& lead) {
+		int f = open(type, config, lead >= 0 ? fd[lead] : -1);
+		if (f < 0 && lead >= 0) {
+			f = open(type, config, -1);
+			if (f >= 0) {
+				fd[e] = f;
+				leader[e] = e;
+				return true;
+			}
+		}
+
+		if (f < 0) {
+			if (type != PERF_TYPE_SOFTWARE && first_error.empty()) {
+				if (errno == ENOENT || errno == EOPNOTSUPP) first_error = "no hardware counters (no PMU, or a VM that doesn't pass it through)";
+				else if (errno == EACCES || errno == EPERM) first_error = "not allowed, see /proc/sys/kernel/perf_event_paranoid";
+				else first_error = std::strerror(errno);
+			}
+			return false;
+		}
+
+		if (lead < 0) lead = e;
+		fd[e] = f;
+		leader[e] = lead;
+		return true;
+	}
+
+	int open(uint32_t type, uint64_t config, int group) {
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = group < 0; // the others start and stop with their leader
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		// this thread, any cpu
+		return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+	}
+#endif
+
+	int fd[event_count] = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+	int leader[event_count] = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 }; // the event that leads the group of each one
+	std::string first_error;
+};
+
+// counts while it's alive
+class region {
+public:
+	explicit region(counters& c) : c(c) { c.start(); }
+	~region() { c.stop(); }
+
+	region(const region&) = delete;
+	region& operator=(const region&) = delete;
+
+private:
+	counters& c;
+};
+
+// "IPC 2.41, L1D miss 1.2%, LLC miss 35.0%, dTLB miss 0.01%, stalled 12.3%", only what's there
+inline std::string format(const sample& s) {
+	std::string out;
+	char buf[48];
+	auto add = [&](const char* fmt, double v) {
+		if (v != v) return; // NaN, not counted
+		std::snprintf(buf, sizeof(buf), fmt, v);
+		out += out.empty() ? "" : ", ";
+		out += buf;
+	};
+
+	add("IPC %.2f", s.ipc());
+	add("L1D miss %.1f%%", 100.0 * s.l1d_miss_rate());
+	add("LLC miss %.1f%%", 100.0 * s.llc_miss_rate());
+	add("dTLB miss %.2f%%", 100.0 * s.dtlb_miss_rate());
+	add("stalled %.1f%%", 100.0 * s.stall_rate());
+	return out;
+}
+
+}
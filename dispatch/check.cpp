@@ -0,0 +1,101 @@
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "dispatch.hpp"
+#include "../bench/bench.hpp"
+
+
+
+// runs every version the CPU supports against the generic one (max difference) and times it.
+// Meant to be compiled WITHOUT -march=native:
+//   g++ -std=c++20 -O2 check.cpp -o check
+
+double maxDiff(const std::vector<float>& a, const std::vector<float>& b) {
+	double max_diff = 0.0;
+	for (size_t i = 0; i < a.size(); ++i) {
+		double d = std::abs(static_cast<double>(a[i]) - b[i]) / std::max(1.0f, std::abs(b[i]));
+		if (!(d <= max_diff)) max_diff = d;
+	}
+	return max_diff;
+}
+
+
+
+int main(int argc, char** argv) {
+
+	bench::suite suite("dispatch", argc, argv);
+
+	// not a multiple of anything, so the tails get used
+	const size_t N = 100003;
+	const int rows = 1003, cols = 2011;
+
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+	std::vector<float> x(N), a(rows * cols), b(cols);
+	for (float& v : x) v = 30.0f * dist(gen);
+	for (float& v : a) v = dist(gen);
+	for (float& v : b) v = dist(gen);
+
+	dispatch::Kernels ref = dispatch::kernels_for(dispatch::ISA::generic);
+
+	std::vector<float> ref_exp2(N), ref_sin(N), ref_gemv(rows, 0.0f), ref_transpose(rows * cols);
+	ref.exp2[3](x.data(), ref_exp2.data(), N);
+	ref.sin(x.data(), ref_sin.data(), N);
+	ref.gemv(a.data(), b.data(), ref_gemv.data(), rows, cols, cols);
+	ref.transpose(a.data(), ref_transpose.data(), rows, cols, cols, rows);
+
+	std::cout << "selected: " << dispatch::kernels.isa << "\n\n";
+	std::printf("%-8s %-10s %12s %12s\n", "isa", "kernel", "time (ms)", "max diff");
+
+	for (dispatch::ISA isa : { dispatch::ISA::generic, dispatch::ISA::sse41, dispatch::ISA::avx2, dispatch::ISA::avx512 }) {
+		if (!dispatch::supported(isa)) continue;
+
+		dispatch::Kernels k = dispatch::kernels_for(isa);
+		std::vector<float> out(N), c(rows), tr(rows * cols);
+
+		// median time per call, in ms
+		auto time = [&](const char* kernel, auto f) { return suite.run(std::string(k.isa) + " " + kernel, f).median_ns * 1e-6; };
+
+		double t = time("exp2<5>", [&]() { k.exp2[3](x.data(), out.data(), N); });
+		std::printf("%-8s %-10s %12.4f %12.3g\n", k.isa, "exp2<5>", t, maxDiff(out, ref_exp2));
+
+		t = time("sin", [&]() { k.sin(x.data(), out.data(), N); });
+		std::printf("%-8s %-10s %12.4f %12.3g\n", k.isa, "sin", t, maxDiff(out, ref_sin));
+
+		// gemv accumulates, so check a single call and time the others
+		k.gemv(a.data(), b.data(), c.data(), rows, cols, cols);
+		double diff = maxDiff(c, ref_gemv);
+		t = time("gemv", [&]() { k.gemv(a.data(), b.data(), c.data(), rows, cols, cols); });
+		std::printf("%-8s %-10s %12.4f %12.3g\n", k.isa, "gemv", t, diff);
+
+		t = time("transpose", [&]() { k.transpose(a.data(), tr.data(), rows, cols, cols, rows); });
+		std::printf("%-8s %-10s %12.4f %12.3g\n", k.isa, "transpose", t, maxDiff(tr, ref_transpose));
+	}
+
+	// the cost of dispatching: 64 elements at a time through the table, against a direct call
+	// to the same version (not inlined either, it's compiled for a different target). Which
+	// version that is gets figured out once here, so the direct one doesn't pay for it
+	std::vector<float> out(64);
+	double dispatched = suite.run("exp2 of 64, dispatched", [&]() { dispatch::exp2(x.data(), out.data(), 64); }).median_ns;
+
+	dispatch::ISA selected = dispatch::ISA::generic;
+	if (dispatch::kernels.exp2[3] == dispatch::avx512::exp2<5>) selected = dispatch::ISA::avx512;
+	else if (dispatch::kernels.exp2[3] == dispatch::avx2::exp2<5>) selected = dispatch::ISA::avx2;
+	else if (dispatch::kernels.exp2[3] == dispatch::sse41::exp2<5>) selected = dispatch::ISA::sse41;
+
+	const char* direct_name = "exp2 of 64, direct";
+	double direct = 0.0;
+	switch (selected) {
+		case dispatch::ISA::avx512: direct = suite.run(direct_name, [&]() { dispatch::avx512::exp2<5>(x.data(), out.data(), 64); }).median_ns; break;
+		case dispatch::ISA::avx2: direct = suite.run(direct_name, [&]() { dispatch::avx2::exp2<5>(x.data(), out.data(), 64); }).median_ns; break;
+		case dispatch::ISA::sse41: direct = suite.run(direct_name, [&]() { dispatch::sse41::exp2<5>(x.data(), out.data(), 64); }).median_ns; break;
+		default: direct = suite.run(direct_name, [&]() { dispatch::generic::exp2<5>(x.data(), out.data(), 64); }).median_ns; break;
+	}
+	std::printf("\nexp2 of 64 elements: %.2f ns dispatched, %.2f ns direct (%s)\n", dispatched, direct, dispatch::kernels.isa);
+
+	return suite.finish();
+}
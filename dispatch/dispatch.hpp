@@ -0,0 +1,308 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <x86intrin.h>
+
+// only the coefficient tables and the scalar functions get used from these, compiled for
+// whatever the build targets. Their __m256 overloads make GCC warn about the ABI without
+// -mavx, but nothing here calls them
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#include "../function approximation/vecmath/exp.hpp"
+#include "../function approximation/trigonometric/sin.hpp"
+#pragma GCC diagnostic pop
+
+
+
+// runtime dispatched versions of the SIMD kernels of this repo: exp2 (vecmath, any degree
+// from 2 to 5), sin (_mm256_sin_ps), gemv (gemv_kernel) and out-of-place transpose
+// (transpose_blocked). Everything else here only compiles with -march=native, which means one
+// binary per machine. Here the kernels are written once (dispatch_kernels.inl) and compiled
+// for SSE4.1, AVX2 + FMA and AVX-512 with #pragma GCC target, like lagrange
+// interpolation/templated.hpp, so this header works with plain -O2, and the best version for
+// the CPU is picked when the program starts.
+//
+// dispatch::kernels is a table of function pointers filled in once, during static
+// initialization, so a call like dispatch::exp2(in, out, n) is a single indirect call, no
+// checks (the function-local static in dispatch_Lagrange needs a guard check every time).
+// The flip side: don't call these from the constructor of another global
+
+namespace dispatch {
+
+using array_func = void (*)(const float* in, float* out, size_t n);
+
+// c += a * b for a rows x cols matrix a (row stride lda), like gemv.cpp
+using gemv_func = void (*)(const float* a, const float* b, float* c, int rows, int cols, int lda);
+
+// b = a^T, a is rows x cols, like out-of-place.cpp
+using transpose_func = void (*)(const float* a, float* b, int rows, int cols, int lda, int ldb);
+
+struct Kernels {
+	const char* isa;
+	array_func exp2[4]; // degree 2 to 5
+	array_func sin;
+	gemv_func gemv;
+	transpose_func transpose;
+};
+
+
+
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+namespace sse41 {
+
+	// no FMA, so fmadd is 2 instructions (and rounds twice)
+	struct simd {
+		using type = __m128;
+		static constexpr size_t width = 4;
+		static constexpr int tile = 4;
+
+		static type set1(float a) { return _mm_set1_ps(a); }
+		static type loadu(const float* p) { return _mm_loadu_ps(p); }
+		static void storeu(float* p, type a) { _mm_storeu_ps(p, a); }
+		static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+		static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+		static type fmadd(type a, type b, type c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+		static type floor(type a) { return _mm_floor_ps(a); }
+		static type and_(type a, type b) { return _mm_and_ps(a, b); }
+		static type xor_(type a, type b) { return _mm_xor_ps(a, b); }
+
+		// a >= b ? v : 0
+		static type select_ge(type a, type b, type v) { return _mm_and_ps(_mm_cmpge_ps(a, b), v); }
+
+		// p * 2^i, i is an integer stored as a float
+		static type scale(type p, type i) {
+			__m128i e = _mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(i), _mm_set1_epi32(127)), 23);
+			return _mm_mul_ps(_mm_castsi128_ps(e), p);
+		}
+
+		static float hsum(type v) {
+			v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+			return _mm_cvtss_f32(_mm_add_ss(v, _mm_shuffle_ps(v, v, 0b01)));
+		}
+
+		static void transpose_tile(const float* a, float* b, int lda, int ldb) {
+			__m128 r0 = _mm_loadu_ps(a + 0 * lda);
+			__m128 r1 = _mm_loadu_ps(a + 1 * lda);
+			__m128 r2 = _mm_loadu_ps(a + 2 * lda);
+			__m128 r3 = _mm_loadu_ps(a + 3 * lda);
+
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+			_mm_storeu_ps(b + 0 * ldb, r0);
+			_mm_storeu_ps(b + 1 * ldb, r1);
+			_mm_storeu_ps(b + 2 * ldb, r2);
+			_mm_storeu_ps(b + 3 * ldb, r3);
+		}
+	};
+
+	#include "dispatch_kernels.inl"
+}
+#pragma GCC pop_options
+
+
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+namespace avx2 {
+
+	// 8x8 transpose in registers, used by the AVX-512 version too
+	inline void transpose_8x8(const float* a, float* b, int lda, int ldb) {
+		__m256 r[8], t[8];
+		for (int k = 0; k < 8; ++k) r[k] = _mm256_loadu_ps(a + k * lda);
+
+		// pairs of rows interleaved, then pairs of pairs, then the 128 bit halves swapped
+		for (int k = 0; k < 8; k += 2) {
+			t[k] = _mm256_unpacklo_ps(r[k], r[k + 1]);
+			t[k + 1] = _mm256_unpackhi_ps(r[k], r[k + 1]);
+		}
+		for (int k = 0; k < 8; k += 4) {
+			r[k] = _mm256_shuffle_ps(t[k], t[k + 2], 0x44);
+			r[k + 1] = _mm256_shuffle_ps(t[k], t[k + 2], 0xEE);
+			r[k + 2] = _mm256_shuffle_ps(t[k + 1], t[k + 3], 0x44);
+			r[k + 3] = _mm256_shuffle_ps(t[k + 1], t[k + 3], 0xEE);
+		}
+		for (int k = 0; k < 4; ++k) {
+			_mm256_storeu_ps(b + k * ldb, _mm256_permute2f128_ps(r[k], r[k + 4], 0x20));
+			_mm256_storeu_ps(b + (k + 4) * ldb, _mm256_permute2f128_ps(r[k], r[k + 4], 0x31));
+		}
+	}
+
+	struct simd {
+		using type = __m256;
+		static constexpr size_t width = 8;
+		static constexpr int tile = 8;
+
+		static type set1(float a) { return _mm256_set1_ps(a); }
+		static type loadu(const float* p) { return _mm256_loadu_ps(p); }
+		static void storeu(float* p, type a) { _mm256_storeu_ps(p, a); }
+		static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+		static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+		static type fmadd(type a, type b, type c) { return _mm256_fmadd_ps(a, b, c); }
+		static type floor(type a) { return _mm256_floor_ps(a); }
+		static type and_(type a, type b) { return _mm256_and_ps(a, b); }
+		static type xor_(type a, type b) { return _mm256_xor_ps(a, b); }
+
+		static type select_ge(type a, type b, type v) { return _mm256_and_ps(_mm256_cmp_ps(a, b, _CMP_GE_OQ), v); }
+
+		static type scale(type p, type i) {
+			__m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(i), _mm256_set1_epi32(127)), 23);
+			return _mm256_mul_ps(_mm256_castsi256_ps(e), p);
+		}
+
+		static float hsum(type v) {
+			__m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+			s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+			return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 0b01)));
+		}
+
+		static void transpose_tile(const float* a, float* b, int lda, int ldb) { transpose_8x8(a, b, lda, ldb); }
+	};
+
+	#include "dispatch_kernels.inl"
+}
+#pragma GCC pop_options
+
+
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx2,fma")
+
+// same false positive as in templated.hpp (_mm256_undefined_* inside the AVX-512 headers)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+namespace avx512 {
+
+	// _mm512_and_ps / _mm512_xor_ps need AVX512DQ, so the bit operations go through integers.
+	// The transpose stays 8x8: a 16x16 tile is 64 shuffles for the same amount of memory
+	// traffic, and the transpose is bound by the memory anyway
+	struct simd {
+		using type = __m512;
+		static constexpr size_t width = 16;
+		static constexpr int tile = 8;
+
+		static type set1(float a) { return _mm512_set1_ps(a); }
+		static type loadu(const float* p) { return _mm512_loadu_ps(p); }
+		static void storeu(float* p, type a) { _mm512_storeu_ps(p, a); }
+		static type sub(type a, type b) { return _mm512_sub_ps(a, b); }
+		static type mul(type a, type b) { return _mm512_mul_ps(a, b); }
+		static type fmadd(type a, type b, type c) { return _mm512_fmadd_ps(a, b, c); }
+		static type floor(type a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+
+		static type and_(type a, type b) {
+			return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+		}
+		static type xor_(type a, type b) {
+			return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+		}
+
+		static type select_ge(type a, type b, type v) { return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(a, b, _CMP_GE_OQ), v); }
+
+		// scalef does the 2^i without going through the exponent bits, like vecmath::exp2
+		static type scale(type p, type i) { return _mm512_scalef_ps(p, i); }
+
+		static float hsum(type v) { return _mm512_reduce_add_ps(v); }
+
+		static void transpose_tile(const float* a, float* b, int lda, int ldb) { avx2::transpose_8x8(a, b, lda, ldb); }
+	};
+
+	#include "dispatch_kernels.inl"
+}
+
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+
+
+
+// fallback for anything older than SSE4.1, plain loops over the scalar versions
+namespace generic {
+
+	template <int Degree>
+	inline void exp2(const float* in, float* out, size_t n) {
+		for (size_t i = 0; i < n; ++i) out[i] = vecmath::exp2<Degree>(in[i]);
+	}
+
+	inline void sin(const float* in, float* out, size_t n) {
+		for (size_t i = 0; i < n; ++i) out[i] = approx_sin(in[i]);
+	}
+
+	inline void gemv(const float* a, const float* b, float* c, int rows, int cols, int lda) {
+		for (int i = 0; i < rows; ++i) {
+			for (int j = 0; j < cols; ++j) {
+				c[i] += a[i * lda + j] * b[j];
+			}
+		}
+	}
+
+	inline void transpose(const float* a, float* b, int rows, int cols, int lda, int ldb) {
+		for (int i = 0; i < rows; ++i) {
+			for (int j = 0; j < cols; ++j) {
+				b[j * ldb + i] = a[i * lda + j];
+			}
+		}
+	}
+
+	inline Kernels kernels(const char* isa) {
+		return { isa, { exp2<2>, exp2<3>, exp2<4>, exp2<5> }, sin, gemv, transpose };
+	}
+}
+
+
+
+enum class ISA { generic, sse41, avx2, avx512 };
+
+inline bool supported(ISA isa) {
+	__builtin_cpu_init();
+
+	switch (isa) {
+		case ISA::avx512: return __builtin_cpu_supports("avx512f");
+		case ISA::avx2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+		case ISA::sse41: return __builtin_cpu_supports("sse4.1");
+		default: return true;
+	}
+}
+
+// the table for a given ISA, whether the CPU has it or not (check supported() first)
+inline Kernels kernels_for(ISA isa) {
+	switch (isa) {
+		case ISA::avx512: return avx512::kernels("avx512");
+		case ISA::avx2: return avx2::kernels("avx2");
+		case ISA::sse41: return sse41::kernels("sse4.1");
+		default: return generic::kernels("generic");
+	}
+}
+
+inline Kernels select_kernels() {
+	for (ISA isa : { ISA::avx512, ISA::avx2, ISA::sse41 }) {
+		if (supported(isa)) return kernels_for(isa);
+	}
+	return kernels_for(ISA::generic);
+}
+
+inline const Kernels kernels = select_kernels();
+
+
+
+template <int Degree = 5>
+inline void exp2(const float* in, float* out, size_t n) {
+	static_assert(Degree >= 2 && Degree <= 5, "exp2 has degrees 2 to 5");
+	kernels.exp2[Degree - 2](in, out, n);
+}
+
+inline void sin(const float* in, float* out, size_t n) {
+	kernels.sin(in, out, n);
+}
+
+inline void gemv(const float* a, const float* b, float* c, int rows, int cols, int lda) {
+	kernels.gemv(a, b, c, rows, cols, lda);
+}
+
+inline void transpose(const float* a, float* b, int rows, int cols, int lda, int ldb) {
+	kernels.transpose(a, b, rows, cols, lda, ldb);
+}
+
+}
@@ -0,0 +1,151 @@
+// kernels of dispatch.hpp, written once against simd (the vector type and operations) and
+// compiled once per ISA by including this file inside a #pragma GCC target region, same as
+// lagrange interpolation/templated_kernel.inl. Don't include it directly
+
+
+
+using vec = simd::type;
+static constexpr size_t W = simd::width;
+
+// out[i] = F(in[i]), 4 registers at a time like vecmath::transform. The tail goes through a
+// small buffer, so F only ever sees whole registers and nothing needs masked loads (SSE has
+// none). F is a template parameter and not a lambda: the lambda's function pointer conversion
+// doesn't get the target options, and GCC warns about the ABI of its return type
+template <vec (*F)(vec)>
+inline void apply(const float* in, float* out, size_t n) {
+	size_t i = 0;
+	for (; i + 4 * W <= n; i += 4 * W) {
+		vec x[4];
+		#pragma GCC unroll 4
+		for (size_t u = 0; u < 4; ++u) x[u] = F(simd::loadu(in + i + u * W));
+		#pragma GCC unroll 4
+		for (size_t u = 0; u < 4; ++u) simd::storeu(out + i + u * W, x[u]);
+	}
+
+	for (; i + W <= n; i += W) simd::storeu(out + i, F(simd::loadu(in + i)));
+
+	if (i < n) {
+		float buffer[W] = {};
+		for (size_t k = 0; k < n - i; ++k) buffer[k] = in[i + k];
+		simd::storeu(buffer, F(simd::loadu(buffer)));
+		for (size_t k = 0; k < n - i; ++k) out[i + k] = buffer[k];
+	}
+}
+
+
+
+// vecmath::exp2: 2^floor(x) * p(x - floor(x)), with the same coefficients
+template <int Degree>
+inline vec exp2_vec(vec x) {
+	const float* c = vecmath::exp2_coeffs<Degree>::c;
+
+	vec fi = simd::floor(x);
+	vec d = simd::sub(x, fi);
+
+	vec p = simd::set1(c[Degree]);
+	#pragma GCC unroll 8
+	for (int k = Degree - 1; k >= 0; --k) p = simd::fmadd(p, d, simd::set1(c[k]));
+
+	return simd::scale(p, fi);
+}
+
+template <int Degree>
+inline void exp2(const float* in, float* out, size_t n) {
+	apply<exp2_vec<Degree>>(in, out, n);
+}
+
+// _mm256_sin_ps: reduce to [0, 2pi), then to [0, pi) remembering the sign, and sin_poly_0_pi
+inline vec sin_vec(vec x) {
+	const vec sign_bit = simd::set1(-0.0f);
+	const vec PI = simd::set1(3.14159265358979323846f);
+
+	vec sign = simd::and_(x, sign_bit);
+	x = simd::xor_(x, sign);
+
+	x = simd::sub(x, simd::mul(simd::set1(6.28318530717958647692f), simd::floor(simd::mul(x, simd::set1(1.0f / 6.28318530717958647692f)))));
+	vec big_sign = simd::select_ge(x, PI, sign_bit);
+	x = simd::sub(x, simd::select_ge(x, PI, PI));
+
+	vec s = simd::set1(0.03681629830044755013571431393746576018286f);
+	s = simd::fmadd(s, x, simd::set1(-0.2313236245461128278420738316442693697179f));
+	s = simd::fmadd(s, x, simd::set1(0.04891814010265938088474976540346788899839f));
+	s = simd::fmadd(s, x, simd::set1(0.9878554618743378113331828267979221403218f));
+	s = simd::mul(s, x);
+
+	return simd::xor_(s, simd::xor_(sign, big_sign));
+}
+
+inline void sin(const float* in, float* out, size_t n) {
+	apply<sin_vec>(in, out, n);
+}
+
+
+
+// c += a * b, gemv_kernel from matrix-vector product/gemv.cpp: 2 rows at a time share the loads of b
+template <int R>
+inline void gemv_rows(const float* a, const float* b, float* c, int cols, int lda) {
+	vec acc[R];
+	for (int r = 0; r < R; ++r) acc[r] = simd::set1(0.0f);
+
+	int j = 0;
+	for (; j + static_cast<int>(W) <= cols; j += W) {
+		vec vb = simd::loadu(b + j);
+		for (int r = 0; r < R; ++r) acc[r] = simd::fmadd(simd::loadu(a + r * lda + j), vb, acc[r]);
+	}
+
+	for (int r = 0; r < R; ++r) {
+		float s = simd::hsum(acc[r]);
+		for (int jj = j; jj < cols; ++jj) s += a[r * lda + jj] * b[jj];
+		c[r] += s;
+	}
+}
+
+inline void gemv(const float* a, const float* b, float* c, int rows, int cols, int lda) {
+	int i = 0;
+	for (; i + 2 <= rows; i += 2) gemv_rows<2>(a + i * lda, b, c + i, cols, lda);
+	if (i < rows) gemv_rows<1>(a + i * lda, b, c + i, cols, lda);
+}
+
+
+
+// transpose_blocked from matrix transposition/out-of-place.cpp: 128x128 blocks, and inside
+// them simd::tile x simd::tile tiles transposed in registers, with a scalar loop for the edges
+inline void transpose_edges(const float* a, float* b, int rows, int cols, int lda, int ldb) {
+	for (int i = 0; i < rows; ++i) {
+		for (int j = 0; j < cols; ++j) {
+			b[j * ldb + i] = a[i * lda + j];
+		}
+	}
+}
+
+inline void transpose_block(const float* a, float* b, int rows, int cols, int lda, int ldb) {
+	static constexpr int T = simd::tile;
+
+	int i = 0;
+	for (; i + T <= rows; i += T) {
+		int j = 0;
+		for (; j + T <= cols; j += T) simd::transpose_tile(a + (i * lda + j), b + (j * ldb + i), lda, ldb);
+		transpose_edges(a + (i * lda + j), b + (j * ldb + i), T, cols - j, lda, ldb);
+	}
+	transpose_edges(a + i * lda, b + i, rows - i, cols, lda, ldb);
+}
+
+inline void transpose(const float* a, float* b, int rows, int cols, int lda, int ldb) {
+	static constexpr int block_size = 128;
+
+	for (int i = 0; i < rows; i += block_size) {
+		int r = std::min(block_size, rows - i);
+
+		for (int j = 0; j < cols; j += block_size) {
+			int c = std::min(block_size, cols - j);
+
+			transpose_block(a + (i * lda + j), b + (j * ldb + i), r, c, lda, ldb);
+		}
+	}
+}
+
+
+
+inline Kernels kernels(const char* isa) {
+	return { isa, { exp2<2>, exp2<3>, exp2<4>, exp2<5> }, sin, gemv, transpose };
+}
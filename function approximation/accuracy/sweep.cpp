@@ -0,0 +1,270 @@
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <bit>
+#include <x86intrin.h>
+
+#include "../exponentials/exp2.hpp"
+#include "../trigonometric/sin.hpp"
+#include "../trigonometric/sincos.hpp"
+#include "../trigonometric/sin_sections.hpp"
+#include "../trigonometric/inverse.hpp"
+#include "../vecmath/array.hpp"
+
+
+
+// exhaustive accuracy check: every finite float in the domain of each kernel goes through
+// it (through the SIMD version when there is one, that's what actually gets used), and gets
+// compared with the double precision libm result. It reports the max ULP, relative and
+// absolute errors and where they happen, and fails (exit code 1) if an error goes over the
+// limit in the table below, so it can be run after changing any coefficient.
+//
+// usage: sweep [name] [--stride k]
+// name only runs the kernels whose name contains it, and stride k only checks every k-th
+// bit pattern (quick runs, stride 1 is everything). All cores are used
+
+
+
+using kernel_func = void (*)(const float*, float*, size_t);
+
+template <float (*F)(float)>
+void scalar(const float* in, float* out, size_t n) {
+	for (size_t i = 0; i < n; ++i) out[i] = F(in[i]);
+}
+
+template <__m256 (*F)(__m256)>
+void avx2(const float* in, float* out, size_t n) {
+	vecmath::transform(in, out, n, F);
+}
+
+#ifdef __AVX512F__
+template <__m512 (*F)(__m512)>
+void avx512(const float* in, float* out, size_t n) {
+	size_t i;
+	for (i = 0; i + 16 <= n; i += 16) _mm512_storeu_ps(out + i, F(_mm512_loadu_ps(in + i)));
+
+	__mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+	_mm512_mask_storeu_ps(out + i, mask, F(_mm512_maskz_loadu_ps(mask, in + i)));
+}
+#endif
+
+double ref_exp2(double x) { return std::exp2(x); }
+double ref_sin(double x) { return std::sin(x); }
+double ref_cos(double x) { return std::cos(x); }
+double ref_tan(double x) { return std::tan(x); }
+double ref_atan(double x) { return std::atan(x); }
+double ref_asin(double x) { return std::asin(x); }
+double ref_acos(double x) { return std::acos(x); }
+
+// the sin half of sincos
+__m256 sincos_sin(__m256 x) {
+	__m256 c;
+	return _mm256_sincos_ps(&c, x);
+}
+
+
+
+struct Kernel {
+	const char* name;
+	kernel_func f;
+	double (*reference)(double);
+
+	// domain, both ends included
+	float lo, hi;
+
+	// fails if the max relative error (or absolute, for the sines) goes over this
+	bool absolute;
+	double limit;
+};
+
+// versions 1 and 2 shift a 32 bit integer, so they're only defined for x in [0, 30) and the
+// scalar version 4 casts to unsigned. The sines would work for bigger x, but the range
+// reduction error grows with x, so there's no point going further than this. The sincos ones
+// get checked again over every float, where the large ones go through Payne-Hanek. tan is checked
+// for relative error, but only up to 1.5: near pi/2 any error in x gets multiplied by 1 / cos^2
+static const Kernel kernels[] = {
+	{ "exp2_v1",           scalar<approx_exp2_v1>, ref_exp2,    0.0f,  29.99f, false, 0.6 },
+	{ "exp2_v2",           scalar<approx_exp2_v2>, ref_exp2,    0.0f,  29.99f, false, 0.07 },
+	{ "exp2_v3",           scalar<approx_exp2_v3>, ref_exp2, -126.0f, 127.0f,  false, 1.01 },
+	{ "exp2_v4",           scalar<approx_exp2_v4>, ref_exp2,    0.0f, 127.0f,  false, 0.07 },
+	{ "exp2_v4 avx2",      avx2<_mm256_exp2_v4_ps>, ref_exp2, -126.0f, 127.0f, false, 0.07 },
+	{ "exp2_v5",           scalar<approx_exp2<2>>, ref_exp2, -126.0f, 127.0f,  false, 4e-3 },
+	{ "exp2_v6",           scalar<approx_exp2<3>>, ref_exp2, -126.0f, 127.0f,  false, 2e-4 },
+	{ "exp2_v7",           scalar<approx_exp2<4>>, ref_exp2, -126.0f, 127.0f,  false, 8e-6 },
+	{ "exp2_v8",           scalar<approx_exp2<5>>, ref_exp2, -126.0f, 127.0f,  false, 4e-7 },
+	{ "exp2_v5 avx2",      avx2<vecmath::exp2<2>>, ref_exp2, -126.0f, 127.0f,  false, 4e-3 },
+	{ "exp2_v6 avx2",      avx2<vecmath::exp2<3>>, ref_exp2, -126.0f, 127.0f,  false, 2e-4 },
+	{ "exp2_v7 avx2",      avx2<vecmath::exp2<4>>, ref_exp2, -126.0f, 127.0f,  false, 8e-6 },
+	{ "exp2_v8 avx2",      avx2<vecmath::exp2<5>>, ref_exp2, -126.0f, 127.0f,  false, 4e-7 },
+	{ "exp2_safe avx2",    avx2<vecmath::exp2_safe<5>>, ref_exp2, -126.0f, 127.0f, false, 4e-7 },
+	{ "exp2_safe_dn avx2", avx2<vecmath::exp2_safe<5, true>>, ref_exp2, -126.0f, 127.0f, false, 4e-7 },
+#ifdef __AVX512F__
+	{ "exp2_v5 avx512",    avx512<vecmath::exp2<2>>, ref_exp2, -126.0f, 127.0f, false, 4e-3 },
+	{ "exp2_v6 avx512",    avx512<vecmath::exp2<3>>, ref_exp2, -126.0f, 127.0f, false, 2e-4 },
+	{ "exp2_v7 avx512",    avx512<vecmath::exp2<4>>, ref_exp2, -126.0f, 127.0f, false, 8e-6 },
+	{ "exp2_v8 avx512",    avx512<vecmath::exp2<5>>, ref_exp2, -126.0f, 127.0f, false, 4e-7 },
+	{ "exp2_safe avx512",  avx512<vecmath::exp2_safe<5>>, ref_exp2, -126.0f, 127.0f, false, 4e-7 },
+#endif
+	{ "approx_sin",        scalar<approx_sin>,     ref_sin,  -1024.0f, 1024.0f, true, 2e-3 },
+	{ "_mm256_sin_ps",     avx2<_mm256_sin_ps>,    ref_sin,  -1024.0f, 1024.0f, true, 2e-3 },
+	{ "sin_sections_3",    scalar<approx_sin_sections<3>>, ref_sin, -1024.0f, 1024.0f, true, 1e-5 },
+	{ "sin_sections_2 avx2", avx2<_mm256_sin_sections_ps<2>>, ref_sin, -1024.0f, 1024.0f, true, 4e-4 },
+	{ "sin_sections_3 avx2", avx2<_mm256_sin_sections_ps<3>>, ref_sin, -1024.0f, 1024.0f, true, 1e-5 },
+	{ "sin_sections_4 avx2", avx2<_mm256_sin_sections_ps<4>>, ref_sin, -1024.0f, 1024.0f, true, 2.5e-7 },
+	{ "approx_cos",        scalar<approx_cos>,     ref_cos,  -1024.0f, 1024.0f, true, 2e-7 },
+	{ "_mm256_sincos_ps",  avx2<sincos_sin>,       ref_sin,  -1024.0f, 1024.0f, true, 2e-7 },
+	{ "_mm256_cos_ps",     avx2<_mm256_cos_ps>,    ref_cos,  -1024.0f, 1024.0f, true, 2e-7 },
+	{ "_mm256_tan_ps",     avx2<_mm256_tan_ps>,    ref_tan,  -1.5f, 1.5f,       false, 5e-7 },
+	{ "approx_atan",       scalar<approx_atan>,    ref_atan, -FLT_MAX, FLT_MAX, false, 3e-7 },
+	{ "_mm256_atan_ps",    avx2<_mm256_atan_ps>,   ref_atan, -FLT_MAX, FLT_MAX, false, 3e-7 },
+	{ "approx_asin",       scalar<approx_asin>,    ref_asin, -1.0f, 1.0f,       false, 4e-7 },
+	{ "_mm256_asin_ps",    avx2<_mm256_asin_ps>,   ref_asin, -1.0f, 1.0f,       false, 4e-7 },
+	{ "approx_acos",       scalar<approx_acos>,    ref_acos, -1.0f, 1.0f,       false, 4e-7 },
+	{ "_mm256_acos_ps",    avx2<_mm256_acos_ps>,   ref_acos, -1.0f, 1.0f,       false, 4e-7 },
+	{ "approx_cos all",    scalar<approx_cos>,     ref_cos,  -FLT_MAX, FLT_MAX, true, 2e-7 },
+	{ "_mm256_sincos all", avx2<sincos_sin>,       ref_sin,  -FLT_MAX, FLT_MAX, true, 2e-7 },
+	{ "_mm256_cos_ps all", avx2<_mm256_cos_ps>,    ref_cos,  -FLT_MAX, FLT_MAX, true, 2e-7 },
+};
+
+
+
+struct Stats {
+	uint64_t count = 0;
+
+	double max_ulp = 0.0, ulp_x = 0.0;
+	double max_rel = 0.0, rel_x = 0.0;
+	double max_abs = 0.0, abs_x = 0.0;
+
+	// NaN compares false with everything, so a NaN error always becomes the new max
+	static void update(double err, float x, double& max, double& where) {
+		if (std::isnan(err)) err = INFINITY;
+		if (err > max) {
+			max = err;
+			where = x;
+		}
+	}
+
+	void add(float x, float approx, double ref) {
+		++count;
+
+		double err = std::abs(static_cast<double>(approx) - ref);
+
+		// size of one float ulp at the reference (the smallest denormal at 0)
+		float r = std::abs(static_cast<float>(ref));
+		double ulp = static_cast<double>(std::nextafter(r, INFINITY)) - r;
+
+		update(err / ulp, x, max_ulp, ulp_x);
+		if (ref != 0.0) update(err / std::abs(ref), x, max_rel, rel_x);
+		update(err, x, max_abs, abs_x);
+	}
+
+	void merge(const Stats& o) {
+		count += o.count;
+		if (o.max_ulp > max_ulp) { max_ulp = o.max_ulp; ulp_x = o.ulp_x; }
+		if (o.max_rel > max_rel) { max_rel = o.max_rel; rel_x = o.rel_x; }
+		if (o.max_abs > max_abs) { max_abs = o.max_abs; abs_x = o.abs_x; }
+	}
+};
+
+
+
+// bit patterns are split in chunks, and each thread grabs the next one until there are
+// none left. Inside a chunk the sign is the same and the magnitude only grows, so whole
+// chunks outside of the domain get skipped without looking at them
+static Stats sweep(const Kernel& k, uint64_t stride) {
+	static constexpr uint64_t chunk_bits = 20;
+	static constexpr uint64_t chunk_size = uint64_t(1) << chunk_bits;
+	static constexpr uint64_t chunks = uint64_t(1) << (32 - chunk_bits);
+
+	std::atomic<uint64_t> next{ 0 };
+	std::mutex m;
+	Stats total;
+
+	auto worker = [&]() {
+		std::vector<float> in(chunk_size), out(chunk_size);
+		Stats s;
+
+		for (uint64_t c = next++; c < chunks; c = next++) {
+			uint64_t first = c << chunk_bits;
+			float v0 = std::bit_cast<float>(static_cast<uint32_t>(first));
+			float v1 = std::bit_cast<float>(static_cast<uint32_t>(first + chunk_size - 1));
+			if (std::max(v0, v1) < k.lo || std::min(v0, v1) > k.hi) continue;
+
+			size_t n = 0;
+			for (uint64_t b = (first + stride - 1) / stride * stride; b < first + chunk_size; b += stride) {
+				float x = std::bit_cast<float>(static_cast<uint32_t>(b));
+				if (std::isfinite(x) && x >= k.lo && x <= k.hi) in[n++] = x;
+			}
+			if (n == 0) continue;
+
+			k.f(in.data(), out.data(), n);
+
+			for (size_t i = 0; i < n; ++i) s.add(in[i], out[i], k.reference(in[i]));
+		}
+
+		std::lock_guard<std::mutex> lock(m);
+		total.merge(s);
+	};
+
+	unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::thread> pool;
+	for (unsigned t = 0; t < threads; ++t) pool.emplace_back(worker);
+	for (std::thread& t : pool) t.join();
+
+	return total;
+}
+
+
+
+int main(int argc, char** argv) {
+
+	std::string filter;
+	uint64_t stride = 1;
+
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--stride") == 0 && i + 1 < argc) stride = std::max(1ull, std::strtoull(argv[++i], nullptr, 10));
+		else filter = argv[i];
+	}
+
+	std::printf("%-18s %-18s %12s %12s %16s %12s %16s %10s\n",
+		"kernel", "domain", "inputs", "max ulp", "(at x)", "max rel", "max abs", "time (s)");
+
+	bool failed = false;
+
+	for (const Kernel& k : kernels) {
+		if (!filter.empty() && std::string(k.name).find(filter) == std::string::npos) continue;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		Stats s = sweep(k, stride);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double err = k.absolute ? s.max_abs : s.max_rel;
+		bool ok = err <= k.limit;
+		failed |= !ok;
+
+		char domain[64];
+		std::snprintf(domain, sizeof(domain), "[%g, %g]", k.lo, k.hi);
+
+		std::printf("%-18s %-18s %12llu %12.4g %16.9g %12.4g %16.4g %10.2f%s\n",
+			k.name, domain, static_cast<unsigned long long>(s.count),
+			s.max_ulp, s.ulp_x, s.max_rel, s.max_abs,
+			std::chrono::duration<double>(end - start).count(),
+			ok ? "" : "  FAILED");
+
+		if (!ok) {
+			std::printf("    max %s error %.4g at x = %.9g, limit is %.4g\n",
+				k.absolute ? "absolute" : "relative", err, k.absolute ? s.abs_x : s.rel_x, k.limit);
+		}
+	}
+
+	return failed ? 1 : 0;
+}
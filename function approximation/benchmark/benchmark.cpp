@@ -0,0 +1,210 @@
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <random>
+#include <x86intrin.h>
+#include <benchmark/benchmark.h>
+
+#include "../exponentials/exp2.hpp"
+#include "../trigonometric/sin.hpp"
+#include "../trigonometric/sin_sections.hpp"
+#include "../trigonometric/inverse.hpp"
+
+
+
+// every approximation (and the std function it replaces) measured two ways:
+//  - latency: each input depends on the last result, like exponentials/benchmarks.cpp
+//  - throughput: independent elements, like exponentials/benchmarks_SIMD.cpp
+// over working sets that fit in L1, L2 and only in DRAM. Besides time and elements per second
+// it reports cycles per element from rdtsc (reference cycles: the same as core cycles only if
+// turbo is off, otherwise they're off by the ratio of the two clocks)
+
+
+
+// {number of floats in the input array}, the output is the same size. So about 8 KB, 256 KB and 128 MB
+static const int64_t sizes[] = { 1 << 10, 1 << 15, 1 << 24 };
+
+static const char* size_label(int64_t n) {
+	return n <= (1 << 10) ? "L1" : n <= (1 << 15) ? "L2" : "DRAM";
+}
+
+static std::vector<float> make_inputs(size_t n, float lo, float hi) {
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<float> dist(lo, hi);
+
+	std::vector<float> in(n);
+	for (float& x : in) x = dist(gen);
+	return in;
+}
+
+static void report(benchmark::State& state, uint64_t cycles, size_t n) {
+	double elements = static_cast<double>(state.iterations()) * static_cast<double>(n);
+	state.SetItemsProcessed(static_cast<int64_t>(elements));
+	state.counters["cycles/element"] = static_cast<double>(cycles) / elements;
+	state.SetLabel(size_label(static_cast<int64_t>(n)));
+}
+
+
+
+// the next input is fma(last result, 0, in[i]): it has the value of in[i] (so it stays in the
+// domain), but can't be computed before the last result is there. The compiler can't drop the
+// multiplication by 0 (the result could be inf or NaN), so the chain costs one FMA more than f,
+// the "identity" benchmark measures just that
+template <float (*F)(float)>
+static void scalar_latency(benchmark::State& state, float lo, float hi) {
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<float> in = make_inputs(n, lo, hi);
+
+	float y = 0.0f;
+	uint64_t start = __rdtsc();
+	for (auto _ : state) {
+		for (size_t i = 0; i < n; ++i) y = F(std::fma(y, 0.0f, in[i]));
+		benchmark::DoNotOptimize(y);
+	}
+	report(state, __rdtsc() - start, n);
+}
+
+template <float (*F)(float)>
+static void scalar_throughput(benchmark::State& state, float lo, float hi) {
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<float> in = make_inputs(n, lo, hi);
+	std::vector<float> out(n);
+
+	uint64_t start = __rdtsc();
+	for (auto _ : state) {
+		for (size_t i = 0; i < n; ++i) out[i] = F(in[i]);
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+	report(state, __rdtsc() - start, n);
+}
+
+template <__m256 (*F)(__m256)>
+static void simd_latency(benchmark::State& state, float lo, float hi) {
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<float> in = make_inputs(n, lo, hi);
+
+	__m256 y = _mm256_setzero_ps();
+	uint64_t start = __rdtsc();
+	for (auto _ : state) {
+		for (size_t i = 0; i < n; i += 8) y = F(_mm256_fmadd_ps(y, _mm256_setzero_ps(), _mm256_loadu_ps(in.data() + i)));
+		benchmark::DoNotOptimize(y);
+	}
+	report(state, __rdtsc() - start, n);
+}
+
+template <__m256 (*F)(__m256)>
+static void simd_throughput(benchmark::State& state, float lo, float hi) {
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<float> in = make_inputs(n, lo, hi);
+	std::vector<float> out(n);
+
+	uint64_t start = __rdtsc();
+	for (auto _ : state) {
+		for (size_t i = 0; i < n; i += 8) _mm256_storeu_ps(out.data() + i, F(_mm256_loadu_ps(in.data() + i)));
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+	report(state, __rdtsc() - start, n);
+}
+
+
+
+float identity(float x) { return x; }
+__m256 identity(__m256 x) { return x; }
+
+float std_exp2(float x) { return std::exp2(x); }
+float std_sin(float x) { return std::sin(x); }
+float std_atan(float x) { return std::atan(x); }
+float std_asin(float x) { return std::asin(x); }
+
+
+
+using benchmark_func = void (*)(benchmark::State&, float, float);
+
+struct Kernel {
+	const char* name;
+	benchmark_func latency;
+	benchmark_func throughput;
+
+	// inputs are uniform in [lo, hi). Versions 1, 2 and the scalar 4 only work for positive x
+	float lo, hi;
+};
+
+template <float (*F)(float)>
+constexpr Kernel scalar(const char* name, float lo, float hi) {
+	return { name, scalar_latency<F>, scalar_throughput<F>, lo, hi };
+}
+
+template <__m256 (*F)(__m256)>
+constexpr Kernel simd(const char* name, float lo, float hi) {
+	return { name, simd_latency<F>, simd_throughput<F>, lo, hi };
+}
+
+static const Kernel kernels[] = {
+	scalar<identity>("identity", -30.0f, 30.0f),
+	scalar<std_exp2>("std_exp2", -30.0f, 30.0f),
+	scalar<approx_exp2_v1>("exp2_v1", 0.0f, 30.0f),
+	scalar<approx_exp2_v2>("exp2_v2", 0.0f, 30.0f),
+	scalar<approx_exp2_v3>("exp2_v3", -30.0f, 30.0f),
+	scalar<approx_exp2_v4>("exp2_v4", 0.0f, 30.0f),
+	scalar<approx_exp2<2>>("exp2_v5", -30.0f, 30.0f),
+	scalar<approx_exp2<3>>("exp2_v6", -30.0f, 30.0f),
+	scalar<approx_exp2<4>>("exp2_v7", -30.0f, 30.0f),
+	scalar<approx_exp2<5>>("exp2_v8", -30.0f, 30.0f),
+	scalar<vecmath::exp2<5, vecmath::scheme::estrin>>("exp2_v8_estrin", -30.0f, 30.0f),
+	scalar<vecmath::exp2<5, vecmath::scheme::horner>>("exp2_v8_horner", -30.0f, 30.0f),
+	scalar<vecmath::expm1<5, vecmath::scheme::horner>>("expm1_5_horner", -0.4f, 0.4f),
+	scalar<vecmath::expm1<5, vecmath::scheme::estrin>>("expm1_5_estrin", -0.4f, 0.4f),
+	scalar<vecmath::expm1<5, vecmath::scheme::mixed>>("expm1_5_mixed", -0.4f, 0.4f),
+	scalar<std_sin>("std_sin", -100.0f, 100.0f),
+	scalar<approx_sin>("approx_sin", -100.0f, 100.0f),
+	scalar<approx_sin_sections<3>>("sin_sections_3", -100.0f, 100.0f),
+	scalar<std_atan>("std_atan", -100.0f, 100.0f),
+	scalar<approx_atan>("approx_atan", -100.0f, 100.0f),
+	scalar<std_asin>("std_asin", -1.0f, 1.0f),
+	scalar<approx_asin>("approx_asin", -1.0f, 1.0f),
+
+	simd<identity>("identity_avx2", -30.0f, 30.0f),
+	simd<_mm256_exp2_v4_ps>("exp2_v4_avx2", -30.0f, 30.0f),
+	simd<vecmath::exp2<2>>("exp2_v5_avx2", -30.0f, 30.0f),
+	simd<vecmath::exp2<3>>("exp2_v6_avx2", -30.0f, 30.0f),
+	simd<vecmath::exp2<4>>("exp2_v7_avx2", -30.0f, 30.0f),
+	simd<vecmath::exp2<5>>("exp2_v8_avx2", -30.0f, 30.0f),
+	simd<vecmath::exp2<5, vecmath::scheme::estrin>>("exp2_v8_estrin_avx2", -30.0f, 30.0f),
+	simd<vecmath::exp2<5, vecmath::scheme::horner>>("exp2_v8_horner_avx2", -30.0f, 30.0f),
+	simd<vecmath::expm1<5, vecmath::scheme::horner>>("expm1_5_horner_avx2", -0.4f, 0.4f),
+	simd<vecmath::expm1<5, vecmath::scheme::estrin>>("expm1_5_estrin_avx2", -0.4f, 0.4f),
+	simd<vecmath::expm1<5, vecmath::scheme::mixed>>("expm1_5_mixed_avx2", -0.4f, 0.4f),
+	simd<vecmath::log2<5, vecmath::scheme::horner>>("log2_5_horner_avx2", 0.01f, 100.0f),
+	simd<vecmath::log2<5, vecmath::scheme::estrin>>("log2_5_estrin_avx2", 0.01f, 100.0f),
+	simd<_mm256_sin_ps>("_mm256_sin_ps", -100.0f, 100.0f),
+	simd<_mm256_sin_sections_ps<2>>("sin_sections_2_avx2", -100.0f, 100.0f),
+	simd<_mm256_sin_sections_ps<3>>("sin_sections_3_avx2", -100.0f, 100.0f),
+	simd<_mm256_sin_sections_ps<4>>("sin_sections_4_avx2", -100.0f, 100.0f),
+	simd<_mm256_atan_ps>("_mm256_atan_ps", -100.0f, 100.0f),
+	simd<_mm256_asin_ps>("_mm256_asin_ps", -1.0f, 1.0f),
+	simd<_mm256_acos_ps>("_mm256_acos_ps", -1.0f, 1.0f),
+};
+
+
+
+// names come out as latency/exp2_v5/32768, so --benchmark_filter=throughput/.*sin works
+int main(int argc, char** argv) {
+
+	for (const Kernel& k : kernels) {
+		for (const char* kind : { "latency", "throughput" }) {
+			benchmark_func f = (kind[0] == 'l') ? k.latency : k.throughput;
+			auto* b = benchmark::RegisterBenchmark((std::string(kind) + "/" + k.name).c_str(), f, k.lo, k.hi);
+			for (int64_t n : sizes) b->Arg(n);
+		}
+	}
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+}
@@ -3,27 +3,27 @@
 #include <cstdint>
 #include <x86intrin.h>
 #include <iomanip>
-#include <chrono>
 
+#include "exp2.hpp"
+#include "../../bench/bench.hpp"
 
 
 
 
-// this measures latency, not throughput, by making each call depend on the last
-template <typename FUNC>
-double timeFunc(const FUNC& f, float* data, int N) {
 
-	for (int i = 0; i < N; ++i) data[i] = -30.0f + static_cast<float>(std::rand()) / (RAND_MAX + 1) * 60.0f;
+// this measures throughput, 8 floats at a time. The kernels write to out, not back to in,
+// so every trial does the same work
+using simd_func = void (*)(const float*, float*);
 
-	auto start = std::chrono::high_resolution_clock::now();
+void timeFunc(bench::suite& suite, const char* name, simd_func f, const float* in, float* out, int N) {
 
-	for (int i = 0; i + 7 < N; i += 8) {
-		f(data + i);
-	}
-
-	auto end = std::chrono::high_resolution_clock::now();
+	bench::result r = suite.run(name, [&]() {
+		for (int i = 0; i + 7 < N; i += 8) {
+			f(in + i, out + i);
+		}
+	}, N);
 
-	return std::chrono::duration<double, std::milli>(end - start).count();
+	std::cout << "Time " << name << ": " << bench::format(r) << "\n";
 }
 
 
@@ -40,116 +40,23 @@ void approx_exp2_v3(float* data) {
 	_mm256_storeu_ps(data, exp2);
 }*/
 
-void approx_exp2_v4(float* data) {
-
-	__m256 x = _mm256_loadu_ps(data);
-
-	__m256i i = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_add_ps(x, _mm256_set1_ps(127.0f)), _mm256_set1_ps(1 << 23)));
-
-	__m256 exp2 = _mm256_castsi256_ps(i);
-
-	_mm256_storeu_ps(data, exp2);
+void approx_exp2_v4(const float* in, float* out) {
+	_mm256_storeu_ps(out, _mm256_exp2_v4_ps(_mm256_loadu_ps(in)));
 }
 
 
 
 
-void approx_exp2_v5(float* data) {
-
-	__m256 x = _mm256_loadu_ps(data);
-
-	__m256 i = _mm256_floor_ps(x);
-	__m256 d = _mm256_sub_ps(x, i);
-
-	__m256 exp2 = _mm256_castsi256_ps(_mm256_cvtps_epi32(_mm256_mul_ps(_mm256_add_ps(i, _mm256_set1_ps(127.0f)), _mm256_set1_ps(1 << 23))));
-
-	exp2 = _mm256_mul_ps(exp2, 
-		_mm256_add_ps(_mm256_mul_ps(
-		_mm256_add_ps(_mm256_mul_ps(
-			_mm256_set1_ps(0.342656060127262f), d), 
-			_mm256_set1_ps(0.649426903806752f)), d), 
-			_mm256_set1_ps(1.003762902276502f))
-	);
-
-	_mm256_storeu_ps(data, exp2);
+// versions 5 to 8, same template as the scalar ones (see vecmath/exp.hpp)
+template <int Degree>
+void approx_exp2(const float* in, float* out) {
+	_mm256_storeu_ps(out, vecmath::exp2<Degree>(_mm256_loadu_ps(in)));
 }
 
-void approx_exp2_v6(float* data) {
 
-	__m256 x = _mm256_loadu_ps(data);
-
-	__m256 i = _mm256_floor_ps(x);
-	__m256 d = _mm256_sub_ps(x, i);
-
-	__m256 exp2 = _mm256_castsi256_ps(_mm256_cvtps_epi32(_mm256_mul_ps(_mm256_add_ps(i, _mm256_set1_ps(127.0f)), _mm256_set1_ps(1 << 23))));
-
-	exp2 = _mm256_mul_ps(exp2, 
-		_mm256_add_ps(_mm256_mul_ps(
-		_mm256_add_ps(_mm256_mul_ps(
-		_mm256_add_ps(_mm256_mul_ps(
-			_mm256_set1_ps(0.079019886937600f), d), 
-			_mm256_set1_ps(0.224126229720834f)), d), 
-			_mm256_set1_ps(0.696838835969343f)), d), 
-			_mm256_set1_ps(0.999811907929616f))
-	);
-
-	_mm256_storeu_ps(data, exp2);
-}
-
-void approx_exp2_v7(float* data) {
-
-	__m256 x = _mm256_loadu_ps(data);
-
-	__m256 i = _mm256_floor_ps(x);
-	__m256 d = _mm256_sub_ps(x, i);
-
-	__m256 exp2 = _mm256_castsi256_ps(_mm256_cvtps_epi32(_mm256_mul_ps(_mm256_add_ps(i, _mm256_set1_ps(127.0f)), _mm256_set1_ps(1 << 23))));
-
-	exp2 = _mm256_mul_ps(exp2, 
-		_mm256_add_ps(_mm256_mul_ps(
-		_mm256_add_ps(_mm256_mul_ps(
-		_mm256_add_ps(_mm256_mul_ps(
-		_mm256_add_ps(_mm256_mul_ps(
-			_mm256_set1_ps(0.013676523800069f), d), 
-			_mm256_set1_ps(0.051666839337489f)), d), 
-			_mm256_set1_ps(0.241710331749456f)), d), 
-			_mm256_set1_ps(0.692931257740765f)), d), 
-			_mm256_set1_ps(1.000007286841045f))
-	);
-
-	_mm256_storeu_ps(data, exp2);
-}
-
-void approx_exp2_v8(float* data) {
-
-	__m256 x = _mm256_loadu_ps(data);
-
-	__m256 i = _mm256_floor_ps(x);
-	__m256 d = _mm256_sub_ps(x, i);
-
-	__m256 exp2 = _mm256_castsi256_ps(_mm256_cvtps_epi32(_mm256_mul_ps(_mm256_add_ps(i, _mm256_set1_ps(127.0f)), _mm256_set1_ps(1 << 23))));
-
-	exp2 = _mm256_mul_ps(exp2, 
-		_mm256_add_ps(_mm256_mul_ps(
-		_mm256_add_ps(_mm256_mul_ps(
-		_mm256_add_ps(_mm256_mul_ps(
-		_mm256_add_ps(_mm256_mul_ps(
-		_mm256_add_ps(_mm256_mul_ps(
-			_mm256_set1_ps(0.001894376824293f), d), 
-			_mm256_set1_ps(0.008940581738581f)), d), 
-			_mm256_set1_ps(0.055876565615224f)), d), 
-			_mm256_set1_ps(0.240131684394877f)), d), 
-			_mm256_set1_ps(0.693156778791506f)), d), 
-			_mm256_set1_ps(0.999999769472682f))
-	);
-
-	_mm256_storeu_ps(data, exp2);
-}
-
-
-void std_exp2(float* data) {
+void std_exp2(const float* in, float* out) {
 	for (int i = 0; i < 8; ++i) {
-		data[i] = std::exp2(data[i]);
+		out[i] = std::exp2(in[i]);
 	}
 }
 
@@ -157,7 +64,9 @@ void std_exp2(float* data) {
 
 
 
-int main() {
+int main(int argc, char** argv) {
+
+	bench::suite suite("exp2 SIMD", argc, argv);
 
 	std::srand(std::time(0));
 
@@ -165,17 +74,21 @@ int main() {
 	std::cout << "How many iterations? ";
 	std::cin >> N;
 
-	float* data = new float[N];
+	float* in = new float[N];
+	float* out = new float[N];
+
+	for (int i = 0; i < N; ++i) in[i] = -30.0f + static_cast<float>(std::rand()) / (RAND_MAX + 1.0f) * 60.0f;
 
-	std::cout << "Time std (ms): " << timeFunc(std_exp2, data, N) << "\n";
-//	std::cout << "Time approximation 3 (ms): " << timeFunc(approx_exp2_v3, data, N) << "\n";
-	std::cout << "Time approximation 4 (ms): " << timeFunc(approx_exp2_v4, data, N) << "\n";
-	std::cout << "Time approximation 5 (ms): " << timeFunc(approx_exp2_v5, data, N) << "\n";
-	std::cout << "Time approximation 6 (ms): " << timeFunc(approx_exp2_v6, data, N) << "\n";
-	std::cout << "Time approximation 7 (ms): " << timeFunc(approx_exp2_v7, data, N) << "\n";
-	std::cout << "Time approximation 8 (ms): " << timeFunc(approx_exp2_v8, data, N) << "\n";
+	timeFunc(suite, "std", std_exp2, in, out, N);
+//	timeFunc(suite, "approximation 3", approx_exp2_v3, in, out, N);
+	timeFunc(suite, "approximation 4", approx_exp2_v4, in, out, N);
+	timeFunc(suite, "approximation 5", approx_exp2<2>, in, out, N);
+	timeFunc(suite, "approximation 6", approx_exp2<3>, in, out, N);
+	timeFunc(suite, "approximation 7", approx_exp2<4>, in, out, N);
+	timeFunc(suite, "approximation 8", approx_exp2<5>, in, out, N);
 
-	delete[] data;
+	delete[] in;
+	delete[] out;
 
-	return 0;
+	return suite.finish();
 }
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <cstdint>
+#include <cfloat>
+#include <x86intrin.h>
+
+#include "../vecmath/vecmath.hpp"
+#include "../../bench/bench.hpp"
+
+
+
+
+
+// activation functions (vecmath/activations.hpp) against the obvious libm loops, for every
+// degree: time per element and max error against a double precision reference. Softmax
+// works on rows x cols, the element-wise ones just on the whole rows * cols array
+
+using array_func = void (*)(const float*, float*, size_t);
+using softmax_func = void (*)(const float*, float*, size_t, size_t);
+
+void std_sigmoid(const float* in, float* out, size_t n) {
+	for (size_t i = 0; i < n; ++i) out[i] = 1.0f / (1.0f + std::exp(-in[i]));
+}
+
+void std_silu(const float* in, float* out, size_t n) {
+	for (size_t i = 0; i < n; ++i) out[i] = in[i] / (1.0f + std::exp(-in[i]));
+}
+
+void std_tanh(const float* in, float* out, size_t n) {
+	for (size_t i = 0; i < n; ++i) out[i] = std::tanh(in[i]);
+}
+
+void std_gelu(const float* in, float* out, size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+		float x = in[i];
+		out[i] = 0.5f * x * (1.0f + std::tanh(0.7978845608028654f * (x + 0.044715f * x * x * x)));
+	}
+}
+
+void std_softmax(const float* in, float* out, size_t rows, size_t cols) {
+	for (size_t r = 0; r < rows; ++r) {
+		const float* x = in + r * cols;
+		float* y = out + r * cols;
+
+		float m = x[0];
+		for (size_t i = 1; i < cols; ++i) m = std::max(m, x[i]);
+
+		float sum = 0.0f;
+		for (size_t i = 0; i < cols; ++i) {
+			y[i] = std::exp(x[i] - m);
+			sum += y[i];
+		}
+
+		float scale = 1.0f / sum;
+		for (size_t i = 0; i < cols; ++i) y[i] *= scale;
+	}
+}
+
+// the 3 pass version with vecmath::exp, to compare with the fused one: the exps only get
+// computed once, but the row is read 3 times (and written twice)
+template <int Degree>
+void softmax_3_pass(const float* in, float* out, size_t rows, size_t cols) {
+	for (size_t r = 0; r < rows; ++r) {
+		const float* x = in + r * cols;
+		float* y = out + r * cols;
+
+		__m256 v_m = _mm256_set1_ps(-FLT_MAX);
+		size_t i = 0;
+		for (; i + 8 <= cols; i += 8) v_m = _mm256_max_ps(v_m, _mm256_loadu_ps(x + i));
+
+		alignas(32) float lanes[8];
+		_mm256_store_ps(lanes, v_m);
+		float m = lanes[0];
+		for (int l = 1; l < 8; ++l) m = std::max(m, lanes[l]);
+		for (; i < cols; ++i) m = std::max(m, x[i]);
+
+		v_m = _mm256_set1_ps(m);
+		__m256 v_sum = _mm256_setzero_ps();
+		vecmath::transform(x, y, cols, [&](__m256 v) {
+			__m256 e = vecmath::exp_safe<Degree>(_mm256_sub_ps(v, v_m));
+			v_sum = _mm256_add_ps(v_sum, e);
+			return e;
+		});
+
+		// the masked tail adds e^(0 - m) for the lanes past the end, take them out again
+		_mm256_store_ps(lanes, v_sum);
+		float sum = 0.0f;
+		for (int l = 0; l < 8; ++l) sum += lanes[l];
+		if (cols % 8) sum -= (8 - cols % 8) * vecmath::exp_safe<Degree>(-m);
+
+		__m256 scale = _mm256_set1_ps(1.0f / sum);
+		vecmath::transform(y, y, cols, [&](__m256 v) { return _mm256_mul_ps(v, scale); });
+	}
+}
+
+
+
+double ref_sigmoid(double x) { return 1.0 / (1.0 + std::exp(-x)); }
+double ref_silu(double x) { return x / (1.0 + std::exp(-x)); }
+double ref_tanh(double x) { return std::tanh(x); }
+double ref_gelu(double x) { return 0.5 * x * (1.0 + std::tanh(0.7978845608028654 * (x + 0.044715 * x * x * x))); }
+
+// max absolute error, NaN counts as infinitely wrong
+double maxErr(const float* in, const float* out, size_t n, double (*ref)(double)) {
+	double max_err = 0.0;
+	for (size_t i = 0; i < n; ++i) {
+		double err = std::abs(out[i] - ref(in[i]));
+		if (!(err <= max_err)) max_err = err;
+	}
+	return max_err;
+}
+
+double softmaxErr(const float* in, const float* out, size_t rows, size_t cols) {
+	double max_err = 0.0;
+	for (size_t r = 0; r < rows; ++r) {
+		const float* x = in + r * cols;
+
+		double m = x[0];
+		for (size_t i = 1; i < cols; ++i) m = std::max(m, static_cast<double>(x[i]));
+
+		double sum = 0.0;
+		for (size_t i = 0; i < cols; ++i) sum += std::exp(x[i] - m);
+
+		for (size_t i = 0; i < cols; ++i) {
+			double err = std::abs(out[r * cols + i] - std::exp(x[i] - m) / sum);
+			if (!(err <= max_err)) max_err = err;
+		}
+	}
+	return max_err;
+}
+
+
+
+void runElementwise(bench::suite& suite, const char* name, double (*ref)(double), const float* in, float* out, size_t N,
+	array_func std_f, array_func f2, array_func f3, array_func f4, array_func f5) {
+
+	const char* labels[] = { "libm", "degree 2", "degree 3", "degree 4", "degree 5" };
+	array_func fs[] = { std_f, f2, f3, f4, f5 };
+
+	for (int k = 0; k < 5; ++k) {
+		bench::result r = suite.run(std::string(name) + " " + labels[k], [&]() { fs[k](in, out, N); }, N);
+		std::printf("%-8s %-10s %s %12.3g max abs error\n", name, labels[k], bench::format(r).c_str(), maxErr(in, out, N, ref));
+	}
+}
+
+void runSoftmax(bench::suite& suite, const char* name, softmax_func f, const float* in, float* out, size_t rows, size_t cols) {
+	bench::result r = suite.run(std::string("softmax ") + name, [&]() { f(in, out, rows, cols); }, rows * cols);
+	std::printf("%-8s %-10s %s %12.3g max abs error\n", "softmax", name, bench::format(r).c_str(), softmaxErr(in, out, rows, cols));
+}
+
+
+
+int main(int argc, char** argv) {
+
+	bench::suite suite("activations", argc, argv);
+
+	std::srand(std::time(0));
+
+	int rows, cols;
+	std::cout << "How many rows? ";
+	std::cin >> rows;
+	std::cout << "How many columns? ";
+	std::cin >> cols;
+
+	size_t N = static_cast<size_t>(rows) * cols;
+
+	float* in = new float[N];
+	float* out = new float[N];
+
+	// about what comes out of a layer, plus a few big ones to check the saturation
+	for (size_t i = 0; i < N; ++i) in[i] = -8.0f + static_cast<float>(std::rand()) / (RAND_MAX + 1.0f) * 16.0f;
+	for (size_t i = 0; i < N; i += 997) in[i] *= 20.0f;
+
+	runElementwise(suite, "sigmoid", ref_sigmoid, in, out, N, std_sigmoid, vecmath::sigmoid<2>, vecmath::sigmoid<3>, vecmath::sigmoid<4>, vecmath::sigmoid<5>);
+	runElementwise(suite, "silu", ref_silu, in, out, N, std_silu, vecmath::silu<2>, vecmath::silu<3>, vecmath::silu<4>, vecmath::silu<5>);
+	runElementwise(suite, "tanh", ref_tanh, in, out, N, std_tanh, vecmath::tanh<2>, vecmath::tanh<3>, vecmath::tanh<4>, vecmath::tanh<5>);
+	runElementwise(suite, "gelu", ref_gelu, in, out, N, std_gelu, vecmath::gelu<2>, vecmath::gelu<3>, vecmath::gelu<4>, vecmath::gelu<5>);
+
+	runSoftmax(suite, "libm", std_softmax, in, out, rows, cols);
+	runSoftmax(suite, "3 pass 5", softmax_3_pass<5>, in, out, rows, cols);
+	runSoftmax(suite, "degree 2", vecmath::softmax<2>, in, out, rows, cols);
+	runSoftmax(suite, "degree 3", vecmath::softmax<3>, in, out, rows, cols);
+	runSoftmax(suite, "degree 4", vecmath::softmax<4>, in, out, rows, cols);
+	runSoftmax(suite, "degree 5", vecmath::softmax<5>, in, out, rows, cols);
+
+	delete[] in;
+	delete[] out;
+
+	return suite.finish();
+}
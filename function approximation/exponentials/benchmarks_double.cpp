@@ -0,0 +1,135 @@
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <x86intrin.h>
+
+#include "../vecmath/vecmath.hpp"
+#include "../../bench/bench.hpp"
+
+
+
+
+
+using array_func = void (*)(const double*, double*, size_t);
+
+// throughput of whole-array calls, same as benchmarks_array.cpp but with doubles. label is
+// what gets printed, name is the whole thing, for the json
+void timeFunc(bench::suite& suite, const std::string& name, const char* label, array_func f, const double* in, double* out, int N) {
+	bench::result r = suite.run(name, [&]() { f(in, out, N); }, N);
+	std::cout << "  Time " << label << ": " << bench::format(r) << "\n";
+}
+
+// max error in ULPs (of the correctly rounded double) against the long double result
+double maxUlp(array_func f, long double (*reference)(long double), const double* in, double* out, int N) {
+	f(in, out, N);
+
+	double max_ulp = 0.0;
+	for (int i = 0; i < N; ++i) {
+		long double ref = reference(in[i]);
+		double r = std::abs(static_cast<double>(ref));
+		double ulp = std::nextafter(r, INFINITY) - r;
+
+		double err = static_cast<double>(std::abs(out[i] - ref) / ulp);
+		if (!(err <= max_ulp)) max_ulp = err;
+	}
+
+	return max_ulp;
+}
+
+
+
+void std_exp(const double* in, double* out, size_t n) {
+	for (size_t i = 0; i < n; ++i) out[i] = std::exp(in[i]);
+}
+
+void std_exp2(const double* in, double* out, size_t n) {
+	for (size_t i = 0; i < n; ++i) out[i] = std::exp2(in[i]);
+}
+
+long double ref_exp(long double x) { return std::exp(x); }
+long double ref_exp2(long double x) { return std::exp2(x); }
+
+// n has to be a multiple of 8 here (N gets rounded down in main)
+template <int TableBits, int Degree, bool Natural>
+void avx2(const double* in, double* out, size_t n) {
+	for (size_t i = 0; i < n; i += 4) {
+		__m256d x = _mm256_loadu_pd(in + i);
+		_mm256_storeu_pd(out + i, Natural ? vecmath::exp_table<TableBits, Degree>(x) : vecmath::exp2_table<TableBits, Degree>(x));
+	}
+}
+
+#ifdef __AVX512F__
+template <int TableBits, int Degree, bool Natural>
+void avx512(const double* in, double* out, size_t n) {
+	for (size_t i = 0; i < n; i += 8) {
+		__m512d x = _mm512_loadu_pd(in + i);
+		_mm512_storeu_pd(out + i, Natural ? vecmath::exp_table<TableBits, Degree>(x) : vecmath::exp2_table<TableBits, Degree>(x));
+	}
+}
+#endif
+
+template <int TableBits, int Degree, bool Natural>
+void scalar(const double* in, double* out, size_t n) {
+	for (size_t i = 0; i < n; ++i) out[i] = Natural ? vecmath::exp_table<TableBits, Degree>(in[i]) : vecmath::exp2_table<TableBits, Degree>(in[i]);
+}
+
+
+
+template <int TableBits, int Degree>
+void report(bench::suite& suite, const double* exp_in, const double* exp2_in, double* out, int N) {
+	std::string name = "TableBits " + std::to_string(TableBits) + ", Degree " + std::to_string(Degree);
+	std::cout << "TableBits " << TableBits << ", Degree " << Degree << " (table: " << (8 << TableBits) << " bytes)\n";
+	std::cout << "  max error exp: " << maxUlp(avx2<TableBits, Degree, true>, ref_exp, exp_in, out, N) << " ULP, exp2: " << maxUlp(avx2<TableBits, Degree, false>, ref_exp2, exp2_in, out, N) << " ULP\n";
+	timeFunc(suite, name + ", scalar", "scalar", scalar<TableBits, Degree, true>, exp_in, out, N);
+	timeFunc(suite, name + ", AVX2", "AVX2", avx2<TableBits, Degree, true>, exp_in, out, N);
+#ifdef __AVX512F__
+	timeFunc(suite, name + ", AVX-512", "AVX-512", avx512<TableBits, Degree, true>, exp_in, out, N);
+	std::cout << "  max error AVX-512 exp: " << maxUlp(avx512<TableBits, Degree, true>, ref_exp, exp_in, out, N) << " ULP\n";
+#endif
+}
+
+
+
+int main(int argc, char** argv) {
+
+	bench::suite suite("exp double", argc, argv);
+
+	int N;
+	std::cout << "How many elements? ";
+	std::cin >> N;
+
+	N -= N % 8;
+
+	double* exp_in = new double[N];
+	double* exp2_in = new double[N];
+	double* out = new double[N];
+
+	// the whole range where the results are normal doubles
+	std::mt19937_64 gen(42);
+	std::uniform_real_distribution<double> exp_dist(-708.0, 709.0);
+	std::uniform_real_distribution<double> exp2_dist(-1022.0, 1023.0);
+	for (int i = 0; i < N; ++i) {
+		exp_in[i] = exp_dist(gen);
+		exp2_in[i] = exp2_dist(gen);
+	}
+
+	std::cout << "max error std::exp: " << maxUlp(std_exp, ref_exp, exp_in, out, N) << " ULP, std::exp2: " << maxUlp(std_exp2, ref_exp2, exp2_in, out, N) << " ULP\n";
+	timeFunc(suite, "std::exp", "std::exp", std_exp, exp_in, out, N);
+
+	report<2, 9>(suite, exp_in, exp2_in, out, N);
+	report<2, 8>(suite, exp_in, exp2_in, out, N);
+	report<3, 8>(suite, exp_in, exp2_in, out, N);
+	report<4, 7>(suite, exp_in, exp2_in, out, N);
+	report<4, 6>(suite, exp_in, exp2_in, out, N);
+	report<7, 5>(suite, exp_in, exp2_in, out, N);
+	report<7, 4>(suite, exp_in, exp2_in, out, N);
+	report<10, 4>(suite, exp_in, exp2_in, out, N);
+	report<10, 3>(suite, exp_in, exp2_in, out, N);
+
+	delete[] exp_in;
+	delete[] exp2_in;
+	delete[] out;
+
+	return suite.finish();
+}
@@ -0,0 +1,131 @@
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <cstdint>
+#include <x86intrin.h>
+
+#include "../vecmath/vecmath.hpp"
+#include "../../bench/bench.hpp"
+#include "../trigonometric/sincos.hpp"
+#include "../trigonometric/sin_sections.hpp"
+
+
+
+
+
+// lookup tables (vecmath/lut.hpp) against the polynomial kernels for the same function:
+// exp2, sin, sigmoid, and GELU with erf, which has no kernel of its own (vecmath::gelu is
+// the tanh approximation of it). Time per element and max error against double, relative for
+// exp2 and absolute for the others. Then the cubic sin with tables from 1 KB to 1 MB, to see
+// what happens when the table stops fitting in L1
+
+// NaN counts as infinitely wrong
+double maxErr(const float* in, const float* out, size_t n, double (*ref)(double), bool relative) {
+	double max_err = 0.0;
+	for (size_t i = 0; i < n; ++i) {
+		double r = ref(in[i]);
+		double err = std::abs(out[i] - r);
+		if (relative) err /= std::abs(r);
+		if (!(err <= max_err)) max_err = err;
+	}
+	return max_err;
+}
+
+
+
+double ref_exp2(double x) { return std::exp2(x); }
+double ref_sin(double x) { return std::sin(x); }
+double ref_sigmoid(double x) { return 1.0 / (1.0 + std::exp(-x)); }
+double ref_gelu_erf(double x) { return 0.5 * x * (1.0 + std::erf(x * 0.70710678118654752)); }
+
+void fill(float* in, size_t N, float lo, float hi) {
+	for (size_t i = 0; i < N; ++i) in[i] = lo + static_cast<float>(std::rand()) / (RAND_MAX + 1.0f) * (hi - lo);
+}
+
+using array_func = void (*)(const float*, float*, size_t);
+
+// f is anything taking (in, out, n)
+template <typename F>
+void run(bench::suite& suite, const char* name, const char* label, F f, double (*ref)(double), bool relative, const float* in, float* out, size_t N) {
+	bench::result r = suite.run(std::string(name) + " " + label, [&]() { f(in, out, N); }, N);
+	std::printf("%-8s %-22s %s %12.3g max %s error\n", name, label, bench::format(r).c_str(), maxErr(in, out, N, ref, relative), relative ? "rel" : "abs");
+}
+
+
+
+int main(int argc, char** argv) {
+
+	bench::suite suite("lut", argc, argv);
+
+	std::srand(std::time(0));
+
+	int N;
+	std::cout << "How many elements? ";
+	std::cin >> N;
+
+	float* in = new float[N];
+	float* out = new float[N];
+
+	using vecmath::lut;
+	using vecmath::interpolation;
+
+	fill(in, N, -30.0f, 30.0f);
+	{
+		lut<interpolation::linear> linear(ref_exp2, -30.0f, 30.0f);
+		lut<interpolation::cubic> cubic(ref_exp2, -30.0f, 30.0f);
+
+		run(suite, "exp2", "libm", [](const float* in, float* out, size_t n) { for (size_t i = 0; i < n; ++i) out[i] = std::exp2(in[i]); }, ref_exp2, true, in, out, N);
+		run(suite, "exp2", "vecmath::exp2<2>", static_cast<array_func>(vecmath::exp2<2>), ref_exp2, true, in, out, N);
+		run(suite, "exp2", "vecmath::exp2<5>", static_cast<array_func>(vecmath::exp2<5>), ref_exp2, true, in, out, N);
+		run(suite, "exp2", "lut linear", linear, ref_exp2, true, in, out, N);
+		run(suite, "exp2", "lut cubic", cubic, ref_exp2, true, in, out, N);
+	}
+
+	fill(in, N, -3.14159265f, 3.14159265f);
+	{
+		lut<interpolation::linear> linear(ref_sin, -3.14159265f, 3.14159265f);
+		lut<interpolation::cubic> cubic(ref_sin, -3.14159265f, 3.14159265f);
+
+		run(suite, "sin", "libm", [](const float* in, float* out, size_t n) { for (size_t i = 0; i < n; ++i) out[i] = std::sin(in[i]); }, ref_sin, false, in, out, N);
+		run(suite, "sin", "_mm256_sin_sections_ps<3>", [](const float* in, float* out, size_t n) { approx_sin_sections<3>(in, out, n); }, ref_sin, false, in, out, N);
+		run(suite, "sin", "_mm256_sincos_ps", [](const float* in, float* out, size_t n) { vecmath::transform(in, out, n, [](__m256 x) { __m256 c; return _mm256_sincos_ps(&c, x); }); }, ref_sin, false, in, out, N);
+		run(suite, "sin", "lut linear", linear, ref_sin, false, in, out, N);
+		run(suite, "sin", "lut cubic", cubic, ref_sin, false, in, out, N);
+	}
+
+	fill(in, N, -10.0f, 10.0f);
+	{
+		lut<interpolation::linear> linear(ref_sigmoid, -10.0f, 10.0f);
+		lut<interpolation::cubic> cubic(ref_sigmoid, -10.0f, 10.0f);
+
+		run(suite, "sigmoid", "vecmath::sigmoid<2>", static_cast<array_func>(vecmath::sigmoid<2>), ref_sigmoid, false, in, out, N);
+		run(suite, "sigmoid", "vecmath::sigmoid<5>", static_cast<array_func>(vecmath::sigmoid<5>), ref_sigmoid, false, in, out, N);
+		run(suite, "sigmoid", "lut linear", linear, ref_sigmoid, false, in, out, N);
+		run(suite, "sigmoid", "lut cubic", cubic, ref_sigmoid, false, in, out, N);
+	}
+
+	fill(in, N, -5.0f, 5.0f);
+	{
+		lut<interpolation::linear> linear(ref_gelu_erf, -5.0f, 5.0f);
+		lut<interpolation::cubic> cubic(ref_gelu_erf, -5.0f, 5.0f);
+
+		run(suite, "gelu", "libm (erf)", [](const float* in, float* out, size_t n) { for (size_t i = 0; i < n; ++i) out[i] = 0.5f * in[i] * (1.0f + std::erf(in[i] * 0.70710678f)); }, ref_gelu_erf, false, in, out, N);
+		run(suite, "gelu", "vecmath::gelu<5> (tanh)", static_cast<array_func>(vecmath::gelu<5>), ref_gelu_erf, false, in, out, N);
+		run(suite, "gelu", "lut linear", linear, ref_gelu_erf, false, in, out, N);
+		run(suite, "gelu", "lut cubic", cubic, ref_gelu_erf, false, in, out, N);
+	}
+
+	// the gathers only stay cheap while the table is in L1, and random inputs touch all of it
+	fill(in, N, -3.14159265f, 3.14159265f);
+	for (size_t bytes : { 1 << 10, 1 << 12, 1 << 14, 1 << 16, 1 << 18, 1 << 20 }) {
+		lut<interpolation::cubic> cubic(ref_sin, -3.14159265f, 3.14159265f, bytes);
+		char label[32];
+		std::snprintf(label, sizeof(label), "lut cubic, %zu KB", bytes >> 10);
+		run(suite, "sin", label, cubic, ref_sin, false, in, out, N);
+	}
+
+	delete[] in;
+	delete[] out;
+
+	return suite.finish();
+}
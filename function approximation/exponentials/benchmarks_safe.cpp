@@ -0,0 +1,99 @@
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <x86intrin.h>
+
+#include "../vecmath/vecmath.hpp"
+#include "../../bench/bench.hpp"
+
+
+
+
+
+using array_func = void (*)(const float*, float*, size_t);
+
+// throughput of whole-array calls, same as benchmarks_array.cpp
+void timeFunc(bench::suite& suite, const std::string& name, array_func f, const float* in, float* out, int N) {
+	bench::result r = suite.run(name, [&]() { f(in, out, N); }, N);
+	std::cout << "Time " << name << ": " << bench::format(r) << "\n";
+}
+
+
+
+// prints 2^x for the inputs that break the unsafe versions, next to std::exp2
+template <typename F>
+void checkSpecial(const char* name, F f) {
+	static const float inputs[] = {
+		-std::numeric_limits<float>::infinity(), -1000.0f, -149.0f, -140.5f, -126.5f, -126.0f,
+		127.5f, 128.0f, 1000.0f, std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN()
+	};
+
+	std::cout << name << ":\n";
+	for (float x : inputs) {
+		std::cout << "  2^" << x << " = " << f(x) << " (std: " << std::exp2(x) << ")\n";
+	}
+}
+
+// the scalar one is overloaded with the SIMD ones, and these run the SIMD ones on a single value
+template <int Degree, bool Denormals>
+float safe_scalar(float x) {
+	return vecmath::exp2_safe<Degree, Denormals>(x);
+}
+
+template <int Degree, bool Denormals>
+float safe_avx2(float x) {
+	return _mm256_cvtss_f32(vecmath::exp2_safe<Degree, Denormals>(_mm256_set1_ps(x)));
+}
+
+#ifdef __AVX512F__
+template <int Degree>
+float safe_avx512(float x) {
+	return _mm512_cvtss_f32(vecmath::exp2_safe<Degree>(_mm512_set1_ps(x)));
+}
+#endif
+
+
+
+int main(int argc, char** argv) {
+
+	bench::suite suite("exp2 safe", argc, argv);
+
+	std::srand(std::time(0));
+
+	int N;
+	std::cout << "How many elements? ";
+	std::cin >> N;
+
+	float* in = new float[N];
+	float* out = new float[N];
+
+	// first everything in [-100, 100], where all versions give the same results, to see the cost
+	// of the extra instructions, and then way outside of [-126, 127] on purpose
+	for (float range : { 100.0f, 200.0f }) {
+		for (int i = 0; i < N; ++i) in[i] = -range + static_cast<float>(std::rand()) / (RAND_MAX + 1.0f) * 2.0f * range;
+
+		std::string where = ", x in [" + std::to_string(static_cast<int>(-range)) + ", " + std::to_string(static_cast<int>(range)) + "]";
+		std::cout << "x in [" << -range << ", " << range << "]:\n";
+		timeFunc(suite, "unsafe, degree 2" + where, vecmath::exp2<2>, in, out, N);
+		timeFunc(suite, "safe, degree 2" + where, vecmath::exp2_safe<2>, in, out, N);
+		timeFunc(suite, "safe with denormals, degree 2" + where, vecmath::exp2_safe<2, true>, in, out, N);
+		timeFunc(suite, "unsafe, degree 5" + where, vecmath::exp2<5>, in, out, N);
+		timeFunc(suite, "safe, degree 5" + where, vecmath::exp2_safe<5>, in, out, N);
+		timeFunc(suite, "safe with denormals, degree 5" + where, vecmath::exp2_safe<5, true>, in, out, N);
+	}
+
+	std::cout << "\n";
+	checkSpecial("scalar", safe_scalar<5, false>);
+	checkSpecial("scalar with denormals", safe_scalar<5, true>);
+	checkSpecial("AVX2", safe_avx2<5, false>);
+	checkSpecial("AVX2 with denormals", safe_avx2<5, true>);
+#ifdef __AVX512F__
+	checkSpecial("AVX-512", safe_avx512<5>);
+#endif
+
+	delete[] in;
+	delete[] out;
+
+	return suite.finish();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <bit>
+#include <x86intrin.h>
+
+#include "../vecmath/exp.hpp"
+
+
+
+// the 2^x approximations from the README, shared by benchmarks.cpp, benchmarks_SIMD.cpp,
+// make_plots.cpp and the accuracy sweep. Versions 1 to 4 only make sense for some x (1 and 2
+// need x in [0, 31), 3 and 4 overflow the exponent bits outside of about [-126, 128), and
+// the scalar 4 can't take negative x at all)
+
+inline float approx_exp2_v1(float x) {
+	// cast x to an positive integer
+	uint32_t i = static_cast<uint32_t>(x);
+	
+	// calculate pow(2, i)
+	uint32_t exp2 = 1 << i;
+	
+	// cast back to float
+	return static_cast<float>(exp2);
+}
+
+inline float approx_exp2_v2(float x) {
+	// cast x to an integer
+	uint32_t i = static_cast<uint32_t>(x);
+	float d = x - static_cast<float>(i);
+	
+	// calculate pow(2, i) and pow(2, i + 1)
+	float exp2_1 = static_cast<float>(1 << i);
+	float exp2_2 = static_cast<float>(1 << (i + 1));
+	
+	// linearly interpolate both results
+	return exp2_1 * (1.0f - d) + exp2_2 * d;
+}
+
+inline float approx_exp2_v3(float x) {
+
+	int i = static_cast<int>(x);
+	
+	// there are 23 bits in the mantissa, so we shift
+	// everything by 23 to place i + 127 in the exponent bits
+	i = (i + 127) << 23;
+
+	// reinterpret bits of i as a float. This will mean the 
+	// exponent will be i + 127, and x will have value pow(2, i)
+	float exp2 = std::bit_cast<float>(i);
+	
+	return exp2;
+}
+
+inline float approx_exp2_v4(float x) {
+
+	// multiplying by 1 << 23 is equivalent to shifting the
+	// integer by 23, but the mantissa will not be wasted
+	x *= 1 << 23;
+	uint32_t i = static_cast<uint32_t>(x);
+
+	// integer addition is a little faster, so only add here (actually about 14% faster)
+	i += 127 << 23;
+
+	// bit cast will make a float with the same bits as i
+	float exp2 = std::bit_cast<float>(i);
+	
+	return exp2;
+}
+
+// versions 5 to 8 were the same function with polynomials of degree 2 to 5 for 2^d - 1 - d,
+// so now they're a single template (the coefficients live in vecmath/exp.hpp). Version 7 used
+// to truncate instead of floor, which was wrong for negative x
+template <int Degree>
+inline float approx_exp2(float x) {
+	return vecmath::exp2<Degree>(x);
+}
+
+
+
+// SIMD version 4. Adding 127 before the conversion makes it work for negative x too
+inline __m256 _mm256_exp2_v4_ps(__m256 x) {
+	return _mm256_castsi256_ps(_mm256_cvtps_epi32(_mm256_mul_ps(_mm256_add_ps(x, _mm256_set1_ps(127.0f)), _mm256_set1_ps(1 << 23))));
+}
@@ -0,0 +1,484 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <bit>
+#include <x86intrin.h>
+
+#include "../exponentials/exp2.hpp"
+#include "../trigonometric/sin.hpp"
+#include "../trigonometric/sincos.hpp"
+#include "../trigonometric/sin_sections.hpp"
+#include "../trigonometric/inverse.hpp"
+#include "../vecmath/vecmath.hpp"
+#include "../../bench/bench.hpp"
+
+
+
+// error against cost for every variant, without a window: for each kernel it measures the
+// ns per element with a dependency chain (latency) and without one (throughput), like
+// benchmark/benchmark.cpp, and the max ULP, relative and absolute errors on inputs spread
+// over all the floats of its domain, like accuracy/sweep.cpp (but sampled, not all of them).
+// Then for each function it finds the Pareto frontier (the kernels nothing else beats on both
+// cost and error) and writes
+//   pareto.csv              one line per kernel, everything measured plus the frontier flags
+//   pareto_<function>.svg   error against latency and against throughput, log-log, with the
+//                           frontier as a staircase
+// and with --budget e it prints the cheapest kernel for each function with error <= e.
+//
+// usage: pareto [name] [--samples n] [--budget e] [--out dir] [bench options]
+// name only runs the kernels whose name contains it, and the bench.hpp options (--reps, --cpu,
+// --json, --baseline, ...) go to the suite that does the timing. The error that counts is relative,
+// except for the sines and cosines (absolute, their relative error near the zeros means nothing)
+
+
+
+using kernel_func = void (*)(const float*, float*, size_t);
+using latency_func = float (*)(const float*, size_t);
+
+template <float (*F)(float)>
+void scalar_array(const float* in, float* out, size_t n) {
+	for (size_t i = 0; i < n; ++i) out[i] = F(in[i]);
+}
+
+// the next input is fma(last result, 0, in[i]), see benchmark/benchmark.cpp. Returns the last
+// result so the chain can't be thrown away
+template <float (*F)(float)>
+float scalar_latency(const float* in, size_t n) {
+	float y = 0.0f;
+	for (size_t i = 0; i < n; ++i) y = F(std::fma(y, 0.0f, in[i]));
+	return y;
+}
+
+// n is always a multiple of 16 here
+template <__m256 (*F)(__m256)>
+void avx2_array(const float* in, float* out, size_t n) {
+	for (size_t i = 0; i < n; i += 8) _mm256_storeu_ps(out + i, F(_mm256_loadu_ps(in + i)));
+}
+
+template <__m256 (*F)(__m256)>
+float avx2_latency(const float* in, size_t n) {
+	__m256 y = _mm256_setzero_ps();
+	for (size_t i = 0; i < n; i += 8) y = F(_mm256_fmadd_ps(y, _mm256_setzero_ps(), _mm256_loadu_ps(in + i)));
+	return _mm256_cvtss_f32(y);
+}
+
+#ifdef __AVX512F__
+template <__m512 (*F)(__m512)>
+void avx512_array(const float* in, float* out, size_t n) {
+	for (size_t i = 0; i < n; i += 16) _mm512_storeu_ps(out + i, F(_mm512_loadu_ps(in + i)));
+}
+
+template <__m512 (*F)(__m512)>
+float avx512_latency(const float* in, size_t n) {
+	__m512 y = _mm512_setzero_ps();
+	for (size_t i = 0; i < n; i += 16) y = F(_mm512_fmadd_ps(y, _mm512_setzero_ps(), _mm512_loadu_ps(in + i)));
+	return _mm512_cvtss_f32(y);
+}
+#endif
+
+
+
+float std_exp2(float x) { return std::exp2(x); }
+float std_exp(float x) { return std::exp(x); }
+float std_log2(float x) { return std::log2(x); }
+float std_sin(float x) { return std::sin(x); }
+float std_cos(float x) { return std::cos(x); }
+float std_atan(float x) { return std::atan(x); }
+float std_asin(float x) { return std::asin(x); }
+float std_acos(float x) { return std::acos(x); }
+
+double ref_exp2(double x) { return std::exp2(x); }
+double ref_exp(double x) { return std::exp(x); }
+double ref_log2(double x) { return std::log2(x); }
+double ref_sin(double x) { return std::sin(x); }
+double ref_cos(double x) { return std::cos(x); }
+double ref_atan(double x) { return std::atan(x); }
+double ref_asin(double x) { return std::asin(x); }
+double ref_acos(double x) { return std::acos(x); }
+
+// the sin half of sincos
+__m256 sincos_sin(__m256 x) {
+	__m256 c;
+	return _mm256_sincos_ps(&c, x);
+}
+
+
+
+struct Kernel {
+	const char* name;
+
+	// what it approximates, there's one plot (and one frontier) per function
+	const char* function;
+	kernel_func f;
+	latency_func latency;
+	double (*reference)(double);
+
+	// the inputs of the timings are uniform in [lo, hi], the error is checked over the same range
+	float lo, hi;
+	bool absolute;
+};
+
+template <float (*F)(float)>
+constexpr Kernel scalar(const char* name, const char* function, double (*reference)(double), float lo, float hi, bool absolute = false) {
+	return { name, function, scalar_array<F>, scalar_latency<F>, reference, lo, hi, absolute };
+}
+
+template <__m256 (*F)(__m256)>
+constexpr Kernel avx2(const char* name, const char* function, double (*reference)(double), float lo, float hi, bool absolute = false) {
+	return { name, function, avx2_array<F>, avx2_latency<F>, reference, lo, hi, absolute };
+}
+
+#ifdef __AVX512F__
+template <__m512 (*F)(__m512)>
+constexpr Kernel avx512(const char* name, const char* function, double (*reference)(double), float lo, float hi, bool absolute = false) {
+	return { name, function, avx512_array<F>, avx512_latency<F>, reference, lo, hi, absolute };
+}
+#endif
+
+// same domains as accuracy/sweep.cpp, except the sines, which get the [-100, 100] of the
+// benchmarks. The exp2 versions that only work for positive x get [0, 30) for all of them,
+// so they're compared on the same inputs
+static const Kernel kernels[] = {
+	scalar<std_exp2>("std::exp2",                     "exp2", ref_exp2, 0.0f, 29.99f),
+	scalar<approx_exp2_v1>("exp2_v1",                 "exp2", ref_exp2, 0.0f, 29.99f),
+	scalar<approx_exp2_v2>("exp2_v2",                 "exp2", ref_exp2, 0.0f, 29.99f),
+	scalar<approx_exp2_v3>("exp2_v3",                 "exp2", ref_exp2, 0.0f, 29.99f),
+	scalar<approx_exp2_v4>("exp2_v4",                 "exp2", ref_exp2, 0.0f, 29.99f),
+	scalar<approx_exp2<2>>("exp2_v5",                 "exp2", ref_exp2, 0.0f, 29.99f),
+	scalar<approx_exp2<3>>("exp2_v6",                 "exp2", ref_exp2, 0.0f, 29.99f),
+	scalar<approx_exp2<4>>("exp2_v7",                 "exp2", ref_exp2, 0.0f, 29.99f),
+	scalar<approx_exp2<5>>("exp2_v8",                 "exp2", ref_exp2, 0.0f, 29.99f),
+	avx2<_mm256_exp2_v4_ps>("exp2_v4 avx2",           "exp2", ref_exp2, 0.0f, 29.99f),
+	avx2<vecmath::exp2<2>>("exp2_v5 avx2",            "exp2", ref_exp2, 0.0f, 29.99f),
+	avx2<vecmath::exp2<3>>("exp2_v6 avx2",            "exp2", ref_exp2, 0.0f, 29.99f),
+	avx2<vecmath::exp2<4>>("exp2_v7 avx2",            "exp2", ref_exp2, 0.0f, 29.99f),
+	avx2<vecmath::exp2<5>>("exp2_v8 avx2",            "exp2", ref_exp2, 0.0f, 29.99f),
+	avx2<vecmath::exp2_safe<5>>("exp2_safe avx2",     "exp2", ref_exp2, 0.0f, 29.99f),
+#ifdef __AVX512F__
+	avx512<vecmath::exp2<2>>("exp2_v5 avx512",        "exp2", ref_exp2, 0.0f, 29.99f),
+	avx512<vecmath::exp2<3>>("exp2_v6 avx512",        "exp2", ref_exp2, 0.0f, 29.99f),
+	avx512<vecmath::exp2<4>>("exp2_v7 avx512",        "exp2", ref_exp2, 0.0f, 29.99f),
+	avx512<vecmath::exp2<5>>("exp2_v8 avx512",        "exp2", ref_exp2, 0.0f, 29.99f),
+#endif
+
+	scalar<std_exp>("std::exp",                       "exp", ref_exp, -87.0f, 88.0f),
+	avx2<vecmath::exp<2>>("exp<2> avx2",              "exp", ref_exp, -87.0f, 88.0f),
+	avx2<vecmath::exp<3>>("exp<3> avx2",              "exp", ref_exp, -87.0f, 88.0f),
+	avx2<vecmath::exp<4>>("exp<4> avx2",              "exp", ref_exp, -87.0f, 88.0f),
+	avx2<vecmath::exp<5>>("exp<5> avx2",              "exp", ref_exp, -87.0f, 88.0f),
+
+	scalar<std_log2>("std::log2",                     "log2", ref_log2, FLT_MIN, FLT_MAX),
+	avx2<vecmath::log2<2>>("log2<2> avx2",            "log2", ref_log2, FLT_MIN, FLT_MAX),
+	avx2<vecmath::log2<3>>("log2<3> avx2",            "log2", ref_log2, FLT_MIN, FLT_MAX),
+	avx2<vecmath::log2<4>>("log2<4> avx2",            "log2", ref_log2, FLT_MIN, FLT_MAX),
+	avx2<vecmath::log2<5>>("log2<5> avx2",            "log2", ref_log2, FLT_MIN, FLT_MAX),
+
+	scalar<std_sin>("std::sin",                       "sin", ref_sin, -100.0f, 100.0f, true),
+	scalar<approx_sin>("approx_sin",                  "sin", ref_sin, -100.0f, 100.0f, true),
+	scalar<approx_sin_sections<3>>("sin_sections_3",  "sin", ref_sin, -100.0f, 100.0f, true),
+	avx2<_mm256_sin_ps>("_mm256_sin_ps",              "sin", ref_sin, -100.0f, 100.0f, true),
+	avx2<_mm256_sin_sections_ps<2>>("sin_sections_2 avx2", "sin", ref_sin, -100.0f, 100.0f, true),
+	avx2<_mm256_sin_sections_ps<3>>("sin_sections_3 avx2", "sin", ref_sin, -100.0f, 100.0f, true),
+	avx2<_mm256_sin_sections_ps<4>>("sin_sections_4 avx2", "sin", ref_sin, -100.0f, 100.0f, true),
+	avx2<sincos_sin>("_mm256_sincos_ps",              "sin", ref_sin, -100.0f, 100.0f, true),
+
+	scalar<std_cos>("std::cos",                       "cos", ref_cos, -100.0f, 100.0f, true),
+	scalar<approx_cos>("approx_cos",                  "cos", ref_cos, -100.0f, 100.0f, true),
+	avx2<_mm256_cos_ps>("_mm256_cos_ps",              "cos", ref_cos, -100.0f, 100.0f, true),
+
+	scalar<std_atan>("std::atan",                     "atan", ref_atan, -100.0f, 100.0f),
+	scalar<approx_atan>("approx_atan",                "atan", ref_atan, -100.0f, 100.0f),
+	avx2<_mm256_atan_ps>("_mm256_atan_ps",            "atan", ref_atan, -100.0f, 100.0f),
+
+	scalar<std_asin>("std::asin",                     "asin", ref_asin, -1.0f, 1.0f),
+	scalar<approx_asin>("approx_asin",                "asin", ref_asin, -1.0f, 1.0f),
+	avx2<_mm256_asin_ps>("_mm256_asin_ps",            "asin", ref_asin, -1.0f, 1.0f),
+
+	scalar<std_acos>("std::acos",                     "acos", ref_acos, -1.0f, 1.0f),
+	scalar<approx_acos>("approx_acos",                "acos", ref_acos, -1.0f, 1.0f),
+	avx2<_mm256_acos_ps>("_mm256_acos_ps",            "acos", ref_acos, -1.0f, 1.0f),
+};
+
+
+
+struct Result {
+	const Kernel* k;
+
+	double latency = 0.0, throughput = 0.0;
+	double max_ulp = 0.0, max_rel = 0.0, max_abs = 0.0;
+
+	bool front_latency = false, front_throughput = false;
+
+	double error() const { return k->absolute ? max_abs : max_rel; }
+};
+
+
+
+// 1024 floats, in L1 like the L1 case of benchmark.cpp
+static constexpr size_t timing_n = 1024;
+
+// floats in the order of their values as unsigned integers, so a range of floats is a range
+// of integers and stepping through it with a fixed stride samples every binade
+static uint32_t ordered(float x) {
+	uint32_t b = std::bit_cast<uint32_t>(x);
+	return (b >> 31) ? ~b : b | 0x80000000u;
+}
+
+static float from_ordered(uint32_t o) {
+	return std::bit_cast<float>((o >> 31) ? o & 0x7fffffffu : ~o);
+}
+
+static void measure_error(Result& res, uint64_t samples) {
+	const Kernel& k = *res.k;
+
+	uint64_t first = ordered(k.lo), last = ordered(k.hi);
+	uint64_t stride = std::max<uint64_t>(1, (last - first + 1) / samples);
+
+	// in blocks of a multiple of 16, the last one padded with copies of hi
+	static constexpr size_t block = 4096;
+	std::vector<float> in(block), out(block);
+
+	for (uint64_t o = first; o <= last;) {
+		size_t n = 0;
+		for (; n < block && o <= last; ++n, o += stride) in[n] = from_ordered(static_cast<uint32_t>(o));
+		size_t used = n;
+		for (; n % 16; ++n) in[n] = k.hi;
+
+		k.f(in.data(), out.data(), n);
+
+		for (size_t i = 0; i < used; ++i) {
+			double ref = k.reference(in[i]);
+			double err = std::abs(static_cast<double>(out[i]) - ref);
+
+			float r = std::abs(static_cast<float>(ref));
+			double ulp = static_cast<double>(std::nextafter(r, INFINITY)) - r;
+
+			// a NaN error is as bad as it gets
+			if (std::isnan(err)) err = INFINITY;
+			res.max_ulp = std::max(res.max_ulp, err / ulp);
+			if (ref != 0.0) res.max_rel = std::max(res.max_rel, err / std::abs(ref));
+			res.max_abs = std::max(res.max_abs, err);
+		}
+	}
+}
+
+// the median of the suite's trials, per element
+static void measure_time(bench::suite& suite, Result& res) {
+	const Kernel& k = *res.k;
+
+	std::vector<float> in(timing_n), out(timing_n);
+	for (size_t i = 0; i < timing_n; ++i) in[i] = k.lo + (k.hi - k.lo) * static_cast<float>(std::rand()) / RAND_MAX;
+
+	bench::result latency = suite.run(std::string(k.name) + " latency", [&]() { bench::keep(k.latency(in.data(), timing_n)); }, timing_n);
+	bench::result throughput = suite.run(std::string(k.name) + " throughput", [&]() {
+		k.f(in.data(), out.data(), timing_n);
+		bench::keep(out[0]);
+	}, timing_n);
+
+	res.latency = latency.per_item(latency.median_ns);
+	res.throughput = throughput.per_item(throughput.median_ns);
+}
+
+
+
+// a kernel is on the frontier if no other kernel for the same function is at least as good
+// on both cost and error and better on one of them
+template <typename Cost>
+static void mark_frontier(std::vector<Result*>& group, Cost cost, bool Result::* flag) {
+	for (Result* a : group) {
+		bool dominated = false;
+		for (Result* b : group) {
+			if (b == a) continue;
+			bool no_worse = cost(*b) <= cost(*a) && b->error() <= a->error();
+			bool better = cost(*b) < cost(*a) || b->error() < a->error();
+			if (no_worse && better) dominated = true;
+		}
+		a->*flag = !dominated;
+	}
+}
+
+
+
+// log-log scatter, one panel per cost. Frontier points in color with the staircase between
+// them, the others in grey, every point labeled
+struct Panel {
+	double x0, y0, w, h;
+	double lx0, lx1, ly0, ly1;
+
+	double px(double v) const { return x0 + (std::log10(v) - lx0) / (lx1 - lx0) * w; }
+	double py(double v) const { return y0 + h - (std::log10(v) - ly0) / (ly1 - ly0) * h; }
+};
+
+static std::string escape(const char* s) {
+	std::string out;
+	for (; *s; ++s) {
+		if (*s == '<') out += "&lt;";
+		else if (*s == '>') out += "&gt;";
+		else if (*s == '&') out += "&amp;";
+		else out += *s;
+	}
+	return out;
+}
+
+template <typename Cost>
+static void draw_panel(std::ofstream& svg, const std::vector<Result*>& group, const Panel& p, Cost cost, bool Result::* flag, const char* xlabel, const char* ylabel) {
+	svg << "<rect x='" << p.x0 << "' y='" << p.y0 << "' width='" << p.w << "' height='" << p.h << "' fill='none' stroke='black'/>\n";
+
+	for (int e = static_cast<int>(std::ceil(p.lx0)); e <= static_cast<int>(std::floor(p.lx1)); ++e) {
+		double x = p.px(std::pow(10.0, e));
+		svg << "<line x1='" << x << "' y1='" << p.y0 << "' x2='" << x << "' y2='" << p.y0 + p.h << "' stroke='#ddd'/>\n";
+		svg << "<text x='" << x << "' y='" << p.y0 + p.h + 14 << "' font-size='10' text-anchor='middle'>1e" << e << "</text>\n";
+	}
+	for (int e = static_cast<int>(std::ceil(p.ly0)); e <= static_cast<int>(std::floor(p.ly1)); ++e) {
+		double y = p.py(std::pow(10.0, e));
+		svg << "<line x1='" << p.x0 << "' y1='" << y << "' x2='" << p.x0 + p.w << "' y2='" << y << "' stroke='#ddd'/>\n";
+		svg << "<text x='" << p.x0 - 4 << "' y='" << y + 3 << "' font-size='10' text-anchor='end'>1e" << e << "</text>\n";
+	}
+	svg << "<text x='" << p.x0 + p.w / 2 << "' y='" << p.y0 + p.h + 30 << "' font-size='12' text-anchor='middle'>" << xlabel << "</text>\n";
+	svg << "<text x='" << p.x0 - 40 << "' y='" << p.y0 + p.h / 2 << "' font-size='12' text-anchor='middle' transform='rotate(-90 " << p.x0 - 40 << " " << p.y0 + p.h / 2 << ")'>" << ylabel << "</text>\n";
+
+	// the staircase: from each frontier point right to the cost of the next one and down to its error
+	std::vector<Result*> front;
+	for (Result* r : group) if (r->*flag) front.push_back(r);
+	std::sort(front.begin(), front.end(), [&](Result* a, Result* b) { return cost(*a) < cost(*b); });
+
+	if (!front.empty()) {
+		svg << "<polyline fill='none' stroke='#d62728' stroke-width='1.5' points='";
+		for (size_t i = 0; i < front.size(); ++i) {
+			if (i > 0) svg << p.px(cost(*front[i])) << "," << p.py(front[i - 1]->error()) << " ";
+			svg << p.px(cost(*front[i])) << "," << p.py(front[i]->error()) << " ";
+		}
+		svg << "'/>\n";
+	}
+
+	for (Result* r : group) {
+		double x = p.px(cost(*r)), y = p.py(r->error());
+		const char* color = (r->*flag) ? "#d62728" : "#999";
+		svg << "<circle cx='" << x << "' cy='" << y << "' r='3.5' fill='" << color << "'/>\n";
+		svg << "<text x='" << x + 5 << "' y='" << y - 4 << "' font-size='9' fill='" << color << "'>" << escape(r->k->name) << "</text>\n";
+	}
+}
+
+static void write_svg(const std::string& path, const char* function, const std::vector<Result*>& group) {
+	auto latency = [](const Result& r) { return r.latency; };
+	auto throughput = [](const Result& r) { return r.throughput; };
+
+	// the same error axis for both panels, each cost axis padded to whole decades around its points
+	double emin = INFINITY, emax = 0.0;
+	for (Result* r : group) {
+		double e = std::max(r->error(), 1e-12);
+		emin = std::min(emin, e);
+		emax = std::max(emax, e);
+	}
+	double ly0 = std::floor(std::log10(emin)), ly1 = std::ceil(std::log10(emax));
+	if (ly1 <= ly0) ly1 = ly0 + 1;
+
+	auto decades = [&](auto cost, double& l0, double& l1) {
+		double lo = INFINITY, hi = 0.0;
+		for (Result* r : group) {
+			lo = std::min(lo, cost(*r));
+			hi = std::max(hi, cost(*r));
+		}
+		l0 = std::floor(std::log10(lo));
+		l1 = std::ceil(std::log10(hi));
+		if (l1 <= l0) l1 = l0 + 1;
+	};
+
+	Panel left{ 70, 40, 400, 300, 0, 0, ly0, ly1 }, right{ 570, 40, 400, 300, 0, 0, ly0, ly1 };
+	decades(latency, left.lx0, left.lx1);
+	decades(throughput, right.lx0, right.lx1);
+
+	bool absolute = group[0]->k->absolute;
+	const char* ylabel = absolute ? "max absolute error" : "max relative error";
+
+	std::ofstream svg(path);
+	svg << "<svg xmlns='http://www.w3.org/2000/svg' width='1060' height='390' font-family='sans-serif'>\n";
+	svg << "<rect width='100%' height='100%' fill='white'/>\n";
+	svg << "<text x='530' y='22' font-size='15' text-anchor='middle'>" << function << ": error against cost (frontier in red)</text>\n";
+	draw_panel(svg, group, left, latency, &Result::front_latency, "latency (ns/element)", ylabel);
+	draw_panel(svg, group, right, throughput, &Result::front_throughput, "throughput (ns/element)", ylabel);
+	svg << "</svg>\n";
+}
+
+
+
+int main(int argc, char** argv) {
+
+	std::string filter, out_dir = ".";
+	uint64_t samples = uint64_t(1) << 20;
+	double budget = -1.0;
+
+	// the options of the suite get passed on, everything else is for here
+	std::vector<char*> bench_args = { argv[0] };
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc) samples = std::max(1ull, std::strtoull(argv[++i], nullptr, 10));
+		else if (std::strcmp(argv[i], "--budget") == 0 && i + 1 < argc) budget = std::atof(argv[++i]);
+		else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) out_dir = argv[++i];
+		else if (argv[i][0] == '-') {
+			bench_args.push_back(argv[i]);
+			if (bench::takes_value(argv[i]) && i + 1 < argc) bench_args.push_back(argv[++i]);
+		}
+		else filter = argv[i];
+	}
+
+	bench::suite suite("pareto", static_cast<int>(bench_args.size()), bench_args.data());
+
+	std::srand(42);
+
+	std::vector<Result> results;
+	for (const Kernel& k : kernels) {
+		if (filter.empty() || std::string(k.name).find(filter) != std::string::npos) results.push_back({ &k });
+	}
+
+	std::printf("%-22s %-6s %12s %12s %12s %12s %12s\n", "kernel", "func", "latency", "throughput", "max ulp", "max rel", "max abs");
+
+	for (Result& r : results) {
+		measure_time(suite, r);
+		measure_error(r, samples);
+		std::printf("%-22s %-6s %12.3f %12.3f %12.4g %12.4g %12.4g\n", r.k->name, r.k->function, r.latency, r.throughput, r.max_ulp, r.max_rel, r.max_abs);
+	}
+
+	// the functions in table order
+	std::vector<const char*> functions;
+	for (const Result& r : results) {
+		if (std::none_of(functions.begin(), functions.end(), [&](const char* f) { return std::strcmp(f, r.k->function) == 0; })) functions.push_back(r.k->function);
+	}
+
+	for (const char* function : functions) {
+		std::vector<Result*> group;
+		for (Result& r : results) if (std::strcmp(r.k->function, function) == 0) group.push_back(&r);
+
+		mark_frontier(group, [](const Result& r) { return r.latency; }, &Result::front_latency);
+		mark_frontier(group, [](const Result& r) { return r.throughput; }, &Result::front_throughput);
+
+		write_svg(out_dir + "/pareto_" + function + ".svg", function, group);
+
+		if (budget >= 0.0) {
+			Result* best = nullptr;
+			for (Result* r : group) {
+				if (r->error() <= budget && (!best || r->throughput < best->throughput)) best = r;
+			}
+			if (best) std::printf("%-6s cheapest with error <= %g: %s (%.3f ns/element)\n", function, budget, best->k->name, best->throughput);
+			else std::printf("%-6s nothing has error <= %g\n", function, budget);
+		}
+	}
+
+	std::ofstream csv(out_dir + "/pareto.csv");
+	csv << "kernel,function,latency_ns,throughput_ns,max_ulp,max_rel,max_abs,error_metric,pareto_latency,pareto_throughput\n";
+	for (const Result& r : results) {
+		char line[512];
+		std::snprintf(line, sizeof(line), "%s,%s,%.4f,%.4f,%.6g,%.6g,%.6g,%s,%d,%d\n",
+			r.k->name, r.k->function, r.latency, r.throughput, r.max_ulp, r.max_rel, r.max_abs,
+			r.k->absolute ? "abs" : "rel", r.front_latency, r.front_throughput);
+		csv << line;
+	}
+
+	return suite.finish();
+}
@@ -0,0 +1,455 @@
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+
+
+
+// Remez exchange algorithm for the polynomial coefficients used everywhere in this folder.
+// It finds P of degree n minimizing max |f(x) - x^shift * P(x^step)| * w(x) over [x_min, x_max],
+// with w = 1 / |f| (relative error, the default) or w = 1 (absolute error), prints the
+// coefficients rounded to float (or double, with --double) as a header for vecmath (poly.hpp)
+// and reports the errors.
+//
+// shift and step cover the forms the kernels actually use, e.g. sin(x) = x * P(x^2) on
+// [0, pi/2] is "sin 0 pi/2 3 --shift 1 --step 2". Everything is done in long double
+//
+// usage: remez <function> <x_min> <x_max> <degree> [--absolute] [--shift s] [--step t] [--offset a] [--double] [--name name]
+// the bounds can be numbers or multiples of pi (pi, -pi/2, 2pi, pi/4...)
+
+using real = long double;
+
+
+
+struct Target {
+	const char* name;
+	std::function<real(real)> f;
+};
+
+static const Target targets[] = {
+	{ "exp2",      [](real x) { return std::exp2(x); } },
+	{ "exp",       [](real x) { return std::exp(x); } },
+	{ "expm1",     [](real x) { return std::expm1(x); } },
+	{ "log",       [](real x) { return std::log(x); } },
+	{ "log2",      [](real x) { return std::log2(x); } },
+	{ "log1p",     [](real x) { return std::log1p(x); } },
+	// ln((1 + x) / (1 - x)) and log2 of the same, what log.hpp approximates after the reduction
+	{ "ln_atanh",   [](real x) { return 2.0L * std::atanh(x); } },
+	{ "log2_atanh", [](real x) { return 2.0L * std::atanh(x) / std::log(2.0L); } },
+	{ "sin",       [](real x) { return std::sin(x); } },
+	{ "cos",       [](real x) { return std::cos(x); } },
+	// cos(x) - 1 without the cancellation, for cos = 1 + x^2 * P(x^2) with the 1 exact
+	{ "cosm1",     [](real x) { real s = std::sin(x / 2); return -2.0L * s * s; } },
+	{ "tan",       [](real x) { return std::tan(x); } },
+	{ "atan",      [](real x) { return std::atan(x); } },
+	{ "asin",      [](real x) { return std::asin(x); } },
+	{ "tanh",      [](real x) { return std::tanh(x); } },
+	{ "sigmoid",   [](real x) { return 1.0L / (1.0L + std::exp(-x)); } },
+	{ "erf",       [](real x) { return std::erf(x); } },
+	{ "sqrt",      [](real x) { return std::sqrt(x); } },
+	{ "cbrt",      [](real x) { return std::cbrt(x); } },
+};
+
+
+
+struct Problem {
+	std::function<real(real)> f;
+	real x_min, x_max;
+	int degree;
+	int shift = 0;
+	int step = 1;
+	bool relative = true;
+
+	// the approximation is done in u = x^step, on the function g(u) = f(x) / x^shift with
+	// weight W(u) = |x|^shift * w(x), so the rest of the code is a plain weighted Remez in u
+	real u_min, u_max;
+
+	real to_x(real u) const {
+		if (step == 1) return u;
+		return std::pow(u, 1.0L / step);
+	}
+
+	// g(u) and W(u). At x = 0 g is usually 0 / 0, so just move a tiny bit away from it
+	void eval(real u, real& g, real& W) const {
+		real x = to_x(u);
+		if (x == 0.0L && shift > 0) x = 1e-12L * (x_max - x_min);
+
+		real fx = f(x);
+		real xs = std::pow(std::abs(x), static_cast<real>(shift));
+		real sign = (shift % 2 == 1 && x < 0.0L) ? -1.0L : 1.0L;
+
+		g = fx / (sign * xs);
+		W = relative ? xs / std::abs(fx) : xs;
+	}
+};
+
+
+static real horner(const std::vector<real>& c, real u) {
+	real r = c.back();
+	for (size_t k = c.size() - 1; k > 0; --k) r = r * u + c[k - 1];
+	return r;
+}
+
+// weighted error at u, the thing that should equioscillate
+static real weighted_error(const Problem& p, const std::vector<real>& c, real u) {
+	real g, W;
+	p.eval(u, g, W);
+	return (horner(c, u) - g) * W;
+}
+
+
+
+
+// Gaussian elimination with partial pivoting, A is (n x n) row major
+static std::vector<real> solve(std::vector<real> A, std::vector<real> b) {
+	size_t n = b.size();
+
+	for (size_t col = 0; col < n; ++col) {
+		size_t pivot = col;
+		for (size_t r = col + 1; r < n; ++r) {
+			if (std::abs(A[r * n + col]) > std::abs(A[pivot * n + col])) pivot = r;
+		}
+		if (pivot != col) {
+			for (size_t k = 0; k < n; ++k) std::swap(A[col * n + k], A[pivot * n + k]);
+			std::swap(b[col], b[pivot]);
+		}
+
+		for (size_t r = col + 1; r < n; ++r) {
+			real m = A[r * n + col] / A[col * n + col];
+			for (size_t k = col; k < n; ++k) A[r * n + k] -= m * A[col * n + k];
+			b[r] -= m * b[col];
+		}
+	}
+
+	std::vector<real> x(n);
+	for (size_t r = n; r-- > 0;) {
+		real s = b[r];
+		for (size_t k = r + 1; k < n; ++k) s -= A[r * n + k] * x[k];
+		x[r] = s / A[r * n + r];
+	}
+
+	return x;
+}
+
+
+// P(u_i) + (-1)^i * E / W(u_i) = g(u_i) for the n + 2 reference points. Returns the
+// coefficients, and E (the levelled error) goes in E
+static std::vector<real> levelled_fit(const Problem& p, const std::vector<real>& ref, real& E) {
+	size_t n = ref.size();
+	std::vector<real> A(n * n);
+	std::vector<real> b(n);
+
+	for (size_t i = 0; i < n; ++i) {
+		real g, W;
+		p.eval(ref[i], g, W);
+
+		real power = 1.0L;
+		for (size_t k = 0; k + 1 < n; ++k) {
+			A[i * n + k] = power;
+			power *= ref[i];
+		}
+		A[i * n + n - 1] = ((i % 2 == 0) ? 1.0L : -1.0L) / W;
+		b[i] = g;
+	}
+
+	std::vector<real> sol = solve(A, b);
+	E = sol.back();
+	sol.pop_back();
+
+	return sol;
+}
+
+
+// zero of the error between a and b (the error has different signs at both ends)
+static real find_zero(const Problem& p, const std::vector<real>& c, real a, real b) {
+	real ea = weighted_error(p, c, a);
+	for (int it = 0; it < 100; ++it) {
+		real m = 0.5L * (a + b);
+		real em = weighted_error(p, c, m);
+		if ((em < 0.0L) == (ea < 0.0L)) {
+			a = m;
+			ea = em;
+		} else {
+			b = m;
+		}
+	}
+	return 0.5L * (a + b);
+}
+
+// point in [a, b] where sign * error is largest: a coarse scan, then golden section
+// search around the best sample
+static real find_extremum(const Problem& p, const std::vector<real>& c, real a, real b, real sign) {
+	constexpr int samples = 64;
+
+	auto h = [&](real u) { return sign * weighted_error(p, c, u); };
+
+	int best = 0;
+	real best_value = -INFINITY;
+	for (int i = 0; i <= samples; ++i) {
+		real u = a + (b - a) * i / samples;
+		real v = h(u);
+		if (v > best_value) {
+			best_value = v;
+			best = i;
+		}
+	}
+
+	real lo = a + (b - a) * std::max(best - 1, 0) / samples;
+	real hi = a + (b - a) * std::min(best + 1, samples) / samples;
+
+	const real inv_phi = (std::sqrt(5.0L) - 1.0L) / 2.0L;
+	real x1 = hi - inv_phi * (hi - lo);
+	real x2 = lo + inv_phi * (hi - lo);
+	real h1 = h(x1), h2 = h(x2);
+	for (int it = 0; it < 80; ++it) {
+		if (h1 < h2) {
+			lo = x1; x1 = x2; h1 = h2;
+			x2 = lo + inv_phi * (hi - lo); h2 = h(x2);
+		} else {
+			hi = x2; x2 = x1; h2 = h1;
+			x1 = hi - inv_phi * (hi - lo); h1 = h(x1);
+		}
+	}
+
+	// the extremum can be at the endpoints, which golden section never reaches
+	real u = 0.5L * (lo + hi);
+	if (h(a) > h(u)) u = a;
+	if (h(b) > h(u)) u = b;
+
+	return u;
+}
+
+
+static real max_error_on_grid(const Problem& p, const std::function<real(real)>& err, int N = 200000) {
+	real m = 0.0L;
+	for (int i = 0; i <= N; ++i) {
+		real u = p.u_min + (p.u_max - p.u_min) * i / N;
+		m = std::max(m, std::abs(err(u)));
+	}
+	return m;
+}
+
+
+static std::vector<real> remez(const Problem& p, real& E, int& iterations) {
+	size_t n = static_cast<size_t>(p.degree) + 2;
+
+	// start at the Chebyshev extrema, which is already close to optimal for smooth functions
+	std::vector<real> ref(n);
+	for (size_t i = 0; i < n; ++i) {
+		real t = -std::cos(M_PIl * i / (n - 1));
+		ref[i] = 0.5L * (p.u_min + p.u_max) + 0.5L * (p.u_max - p.u_min) * t;
+	}
+
+	std::vector<real> c;
+	for (iterations = 1; iterations <= 100; ++iterations) {
+		c = levelled_fit(p, ref, E);
+
+		std::vector<real> zeros;
+		for (size_t i = 0; i + 1 < n; ++i) zeros.push_back(find_zero(p, c, ref[i], ref[i + 1]));
+
+		std::vector<real> new_ref(n);
+		real max_e = 0.0L, min_e = INFINITY;
+		for (size_t i = 0; i < n; ++i) {
+			real a = (i == 0) ? p.u_min : zeros[i - 1];
+			real b = (i == n - 1) ? p.u_max : zeros[i];
+			real sign = (weighted_error(p, c, ref[i]) < 0.0L) ? -1.0L : 1.0L;
+
+			new_ref[i] = find_extremum(p, c, a, b, sign);
+
+			real e = std::abs(weighted_error(p, c, new_ref[i]));
+			max_e = std::max(max_e, e);
+			min_e = std::min(min_e, e);
+		}
+
+		ref = new_ref;
+
+		// converged when all the extrema have (almost) the same size
+		if (max_e - min_e <= 1e-6L * max_e) break;
+	}
+
+	return c;
+}
+
+
+
+
+static bool parse_bound(const char* s, real& v) {
+	std::string str(s);
+	size_t pi_pos = str.find("pi");
+	if (pi_pos == std::string::npos) {
+		char* end;
+		v = std::strtold(s, &end);
+		return *end == '\0' && end != s;
+	}
+
+	// [-][k]pi[/d]
+	std::string before = str.substr(0, pi_pos);
+	std::string after = str.substr(pi_pos + 2);
+
+	real k = 1.0L;
+	if (before == "-") k = -1.0L;
+	else if (!before.empty()) k = std::strtold(before.c_str(), nullptr);
+
+	real d = 1.0L;
+	if (!after.empty()) {
+		if (after[0] != '/') return false;
+		d = std::strtold(after.c_str() + 1, nullptr);
+	}
+
+	v = k * M_PIl / d;
+	return true;
+}
+
+
+// the polynomial in u evaluated in T, with the coefficients and u rounded to T first
+template <typename T>
+static real horner(const std::vector<real>& c, real u) {
+	T ut = static_cast<T>(u);
+	T r = static_cast<T>(c.back());
+	for (size_t k = c.size() - 1; k > 0; --k) r = std::fma(r, ut, static_cast<T>(c[k - 1]));
+	return r;
+}
+
+
+static void usage() {
+	std::cerr << "usage: remez <function> <x_min> <x_max> <degree> [--absolute] [--shift s] [--step t] [--offset a] [--double] [--name name]\n";
+	std::cerr << "functions:";
+	for (const Target& t : targets) std::cerr << " " << t.name;
+	std::cerr << "\n";
+}
+
+
+
+int main(int argc, char** argv) {
+
+	if (argc < 5) {
+		usage();
+		return 1;
+	}
+
+	const Target* target = nullptr;
+	for (const Target& t : targets) {
+		if (std::strcmp(t.name, argv[1]) == 0) target = &t;
+	}
+	if (!target) {
+		std::cerr << "unknown function " << argv[1] << "\n";
+		usage();
+		return 1;
+	}
+
+	Problem p;
+	p.f = target->f;
+	if (!parse_bound(argv[2], p.x_min) || !parse_bound(argv[3], p.x_max) || p.x_min >= p.x_max) {
+		std::cerr << "bad interval\n";
+		return 1;
+	}
+	p.degree = std::atoi(argv[4]);
+	if (p.degree < 0 || p.degree > 20) {
+		std::cerr << "degree must be in [0, 20]\n";
+		return 1;
+	}
+
+	std::string name = std::string(argv[1]) + "_poly";
+	real offset = 0.0L;
+	bool as_double = false;
+	for (int i = 5; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--absolute") p.relative = false;
+		else if (arg == "--relative") p.relative = true;
+		else if (arg == "--shift" && i + 1 < argc) p.shift = std::atoi(argv[++i]);
+		else if (arg == "--step" && i + 1 < argc) p.step = std::atoi(argv[++i]);
+		else if (arg == "--name" && i + 1 < argc) name = argv[++i];
+		else if (arg == "--double") as_double = true;
+		else if (arg == "--offset" && i + 1 < argc) {
+			if (!parse_bound(argv[++i], offset)) {
+				usage();
+				return 1;
+			}
+		}
+		else {
+			usage();
+			return 1;
+		}
+	}
+
+	// f(a + x) on [x_min, x_max], for local polynomials centered somewhere else than 0
+	if (offset != 0.0L) p.f = [f = p.f, offset](real x) { return f(offset + x); };
+
+	if (p.shift < 0 || p.step < 1 || (p.step > 1 && p.x_min < 0.0L)) {
+		std::cerr << "need shift >= 0, step >= 1, and x_min >= 0 if step > 1 (fit the symmetric part instead)\n";
+		return 1;
+	}
+
+	p.u_min = std::pow(p.x_min, static_cast<real>(p.step));
+	p.u_max = std::pow(p.x_max, static_cast<real>(p.step));
+
+	// relative error makes no sense where f is 0, unless the shift takes care of it
+	for (int i = 0; i <= 1000; ++i) {
+		real g, W;
+		p.eval(p.u_min + (p.u_max - p.u_min) * i / 1000, g, W);
+		if (!std::isfinite(g) || !std::isfinite(W)) {
+			std::cerr << "the weighted function isn't finite on the interval (zero of f with relative error? try --shift or --absolute)\n";
+			return 1;
+		}
+	}
+
+
+
+	real E;
+	int iterations;
+	std::vector<real> c = remez(p, E, iterations);
+
+	// what the kernels actually get: exact evaluation with the coefficients rounded to float (or
+	// double), and the whole thing in that type (u rounded, Horner with fma)
+	const char* type = as_double ? "double" : "float";
+	std::vector<real> cr(c.size());
+	for (size_t k = 0; k < c.size(); ++k) cr[k] = as_double ? static_cast<double>(c[k]) : static_cast<float>(c[k]);
+
+	real err_exact = max_error_on_grid(p, [&](real u) { return weighted_error(p, c, u); });
+	real err_rounded = max_error_on_grid(p, [&](real u) { return weighted_error(p, cr, u); });
+	real err_float = max_error_on_grid(p, [&](real u) {
+		real r = as_double ? horner<double>(cr, u) : horner<float>(cr, u);
+		real ur = as_double ? static_cast<double>(u) : static_cast<float>(u);
+
+		real g, W;
+		p.eval(ur, g, W);
+		return (r - g) * W;
+	});
+
+	const char* kind = p.relative ? "relative" : "absolute";
+
+	std::fprintf(stderr, "%d iterations, levelled error %.3Le\n", iterations, std::abs(E));
+	std::fprintf(stderr, "max %s error: %.3Le (exact coefficients), %.3Le (%s coefficients), %.3Le (%s evaluation)\n",
+		kind, err_exact, err_rounded, type, err_float, type);
+
+
+
+	std::string form = std::string(argv[1]) + (offset != 0.0L ? "(a + x) ~ " : "(x) ~ ");
+	if (p.shift == 1) form += "x * ";
+	else if (p.shift > 1) form += "x^" + std::to_string(p.shift) + " * ";
+	form += (p.step == 1) ? "P(x)" : "P(x^" + std::to_string(p.step) + ")";
+
+	std::printf("#pragma once\n\n#include \"poly.hpp\"\n\n\n\n");
+	std::printf("// generated by remez/remez.cpp: %s on [%.9Lg, %.9Lg], degree %d, minimax %s error\n",
+		form.c_str(), p.x_min, p.x_max, p.degree, kind);
+	if (offset != 0.0L) std::printf("// a = %.9Lg\n", offset);
+	std::printf("// max error %.2Le, %.2Le with the coefficients rounded to %s, %.2Le evaluated in %s\n\n",
+		err_exact, err_rounded, type, err_float, type);
+	std::printf("namespace vecmath {\n\n");
+
+	// polynomial<> only takes floats, doubles go in a plain array
+	if (as_double) std::printf("static constexpr double %s[] = { ", name.c_str());
+	else std::printf("using %s = polynomial<", name.c_str());
+	for (size_t k = 0; k < cr.size(); ++k) {
+		if (as_double) std::printf("%s%.17e", k ? ", " : "", static_cast<double>(cr[k]));
+		else std::printf("%s%.9ef", k ? ", " : "", static_cast<double>(cr[k]));
+	}
+	std::printf(as_double ? " };\n\n}\n" : ">;\n\n}\n");
+
+	return 0;
+}
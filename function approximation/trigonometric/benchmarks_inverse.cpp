@@ -0,0 +1,107 @@
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <cstdint>
+#include <x86intrin.h>
+
+#include "inverse.hpp"
+#include "../../bench/bench.hpp"
+
+
+
+// atan, atan2, asin and acos against libm (the float versions, std::atan(float) and so on),
+// scalar and AVX2. Times are per element, errors are max relative against the double libm
+// functions. Then the special cases of atan2, where only the exact value is right
+
+template <typename Ref>
+double maxRelErr(const float* out, int N, Ref ref) {
+	double max_err = 0.0;
+	for (int i = 0; i < N; ++i) {
+		double r = ref(i);
+		double err = std::abs(out[i] - r) / std::abs(r);
+		if (r != 0.0 && !(err <= max_err)) max_err = err;
+	}
+	return max_err;
+}
+
+float random(float lo, float hi) {
+	return lo + static_cast<float>(std::rand()) / (RAND_MAX + 1.0f) * (hi - lo);
+}
+
+
+
+int main(int argc, char** argv) {
+
+	bench::suite suite("inverse", argc, argv);
+
+	std::srand(std::time(0));
+
+	int N;
+	std::cout << "How many elements? ";
+	std::cin >> N;
+
+	float* x = new float[N];
+	float* y = new float[N];
+	float* out = new float[N];
+
+	// the error only after the timing, out is what the timed function left there
+	auto report = [&](const char* name, auto f, auto ref) {
+		bench::result r = suite.run(name, f, N);
+		std::printf("%-20s %s   max rel error %.3g\n", name, bench::format(r).c_str(), maxRelErr(out, N, ref));
+	};
+
+	// atan on [-100, 100], the 1 / x side gets most of it
+	for (int i = 0; i < N; ++i) x[i] = random(-100.0f, 100.0f);
+	auto atan_ref = [&](int i) { return std::atan(static_cast<double>(x[i])); };
+
+	report("std::atan", [&]() { for (int i = 0; i < N; ++i) out[i] = std::atan(x[i]); }, atan_ref);
+	report("approx_atan", [&]() { for (int i = 0; i < N; ++i) out[i] = approx_atan(x[i]); }, atan_ref);
+	report("_mm256_atan_ps", [&]() { approx_atan(x, out, N); }, atan_ref);
+
+	// atan2 of points in the square [-1, 1]^2, all 4 quadrants
+	for (int i = 0; i < N; ++i) y[i] = random(-1.0f, 1.0f);
+	for (int i = 0; i < N; ++i) x[i] = random(-1.0f, 1.0f);
+	auto atan2_ref = [&](int i) { return std::atan2(static_cast<double>(y[i]), static_cast<double>(x[i])); };
+
+	report("std::atan2", [&]() { for (int i = 0; i < N; ++i) out[i] = std::atan2(y[i], x[i]); }, atan2_ref);
+	report("approx_atan2", [&]() { for (int i = 0; i < N; ++i) out[i] = approx_atan2(y[i], x[i]); }, atan2_ref);
+	report("_mm256_atan2_ps", [&]() { approx_atan2(y, x, out, N); }, atan2_ref);
+
+	// asin and acos on [-1, 1]
+	auto asin_ref = [&](int i) { return std::asin(static_cast<double>(x[i])); };
+	auto acos_ref = [&](int i) { return std::acos(static_cast<double>(x[i])); };
+
+	report("std::asin", [&]() { for (int i = 0; i < N; ++i) out[i] = std::asin(x[i]); }, asin_ref);
+	report("approx_asin", [&]() { for (int i = 0; i < N; ++i) out[i] = approx_asin(x[i]); }, asin_ref);
+	report("_mm256_asin_ps", [&]() { approx_asin(x, out, N); }, asin_ref);
+
+	report("std::acos", [&]() { for (int i = 0; i < N; ++i) out[i] = std::acos(x[i]); }, acos_ref);
+	report("approx_acos", [&]() { for (int i = 0; i < N; ++i) out[i] = approx_acos(x[i]); }, acos_ref);
+	report("_mm256_acos_ps", [&]() { approx_acos(x, out, N); }, acos_ref);
+
+	// signed zeros, infinities and NaN, scalar and vector against std::atan2
+	const float special[] = { 0.0f, -0.0f, 1.0f, -1.0f, INFINITY, -INFINITY, NAN };
+	int wrong = 0;
+	for (float sy : special) {
+		for (float sx : special) {
+			float ref = std::atan2(sy, sx);
+			float s = approx_atan2(sy, sx);
+			float v = _mm256_cvtss_f32(_mm256_atan2_ps(_mm256_set1_ps(sy), _mm256_set1_ps(sx)));
+
+			for (float got : { s, v }) {
+				bool same = std::isnan(ref) ? std::isnan(got) : (std::abs(got - ref) <= 2e-7f * std::abs(ref) && std::signbit(got) == std::signbit(ref));
+				if (!same) {
+					std::printf("atan2(%g, %g) = %g, should be %g\n", sy, sx, got, ref);
+					++wrong;
+				}
+			}
+		}
+	}
+	std::printf("atan2 special cases: %d wrong\n", wrong);
+
+	delete[] x;
+	delete[] y;
+	delete[] out;
+
+	return suite.finish();
+}
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <cstdint>
+#include <x86intrin.h>
+
+#include "sin.hpp"
+#include "sincos.hpp"
+#include "sin_sections.hpp"
+#include "../../bench/bench.hpp"
+
+
+
+// sin with one polynomial for the whole half period (_mm256_sin_ps, degree 4 on [0, pi), and
+// the sin half of _mm256_sincos_ps, degree 7 odd on [-pi/4, pi/4]) against the piecewise
+// ones of sin_sections.hpp, degree 2 to 4 on 8 sections. Times are per element, errors are
+// absolute, against std::sin in double
+
+double maxErr(const float* in, const float* out, int N) {
+	double max_err = 0.0;
+	for (int i = 0; i < N; ++i) {
+		double err = std::abs(out[i] - std::sin(static_cast<double>(in[i])));
+		if (!(err <= max_err)) max_err = err;
+	}
+	return max_err;
+}
+
+__m256 sincos_sin(__m256 x) {
+	__m256 c;
+	return _mm256_sincos_ps(&c, x);
+}
+
+
+
+int main(int argc, char** argv) {
+
+	bench::suite suite("sin sections", argc, argv);
+
+	std::srand(std::time(0));
+
+	int N;
+	std::cout << "How many elements? ";
+	std::cin >> N;
+
+	float* in = new float[N];
+	float* out = new float[N];
+
+	for (int i = 0; i < N; ++i) in[i] = -100.0f + static_cast<float>(std::rand()) / (RAND_MAX + 1.0f) * 200.0f;
+
+	auto report = [&](const char* name, auto f) {
+		bench::result r = suite.run(name, f, N);
+		std::printf("%-30s %s   max abs error %.3g\n", name, bench::format(r).c_str(), maxErr(in, out, N));
+	};
+
+	report("std::sin", [&]() { for (int i = 0; i < N; ++i) out[i] = std::sin(in[i]); });
+	report("_mm256_sin_ps", [&]() { vecmath::transform(in, out, N, _mm256_sin_ps); });
+	report("_mm256_sincos_ps (sin only)", [&]() { vecmath::transform(in, out, N, sincos_sin); });
+	report("_mm256_sin_sections_ps<2>", [&]() { approx_sin_sections<2>(in, out, N); });
+	report("_mm256_sin_sections_ps<3>", [&]() { approx_sin_sections<3>(in, out, N); });
+	report("_mm256_sin_sections_ps<4>", [&]() { approx_sin_sections<4>(in, out, N); });
+
+	delete[] in;
+	delete[] out;
+
+	return suite.finish();
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <cstdint>
+#include <x86intrin.h>
+
+#include "sin.hpp"
+#include "sincos.hpp"
+#include "../../bench/bench.hpp"
+
+
+
+// sin and cos of the same angles: separate std::sin and std::cos calls, glibc's sincosf, two
+// separate SIMD calls (each doing its own range reduction) and the fused _mm256_sincos_ps,
+// then the same with angles between 2^20 and 2^120, where the reduction is Payne-Hanek.
+// Also tan against std::tan. Times are per element (per angle for the sincos ones)
+
+double maxErr(const float* in, const float* out, int N, double (*ref)(double)) {
+	double max_err = 0.0;
+	for (int i = 0; i < N; ++i) {
+		double err = std::abs(out[i] - ref(in[i]));
+		if (!(err <= max_err)) max_err = err;
+	}
+	return max_err;
+}
+
+double ref_sin(double x) { return std::sin(x); }
+double ref_cos(double x) { return std::cos(x); }
+double ref_tan(double x) { return std::tan(x); }
+
+
+
+int main(int argc, char** argv) {
+
+	bench::suite suite("sincos", argc, argv);
+
+	std::srand(std::time(0));
+
+	int N;
+	std::cout << "How many elements? ";
+	std::cin >> N;
+
+	float* in = new float[N];
+	float* s = new float[N];
+	float* c = new float[N];
+
+	for (int i = 0; i < N; ++i) in[i] = -100.0f + static_cast<float>(std::rand()) / (RAND_MAX + 1.0f) * 200.0f;
+
+	auto report = [&](const char* name, auto f) {
+		bench::result r = suite.run(name, f, N);
+		std::printf("%-30s %s   max abs error sin %.3g, cos %.3g\n", name, bench::format(r).c_str(), maxErr(in, s, N, ref_sin), maxErr(in, c, N, ref_cos));
+	};
+
+	report("std::sin + std::cos", [&]() {
+		for (int i = 0; i < N; ++i) {
+			s[i] = std::sin(in[i]);
+			c[i] = std::cos(in[i]);
+		}
+	});
+
+	report("sincosf (glibc)", [&]() {
+		for (int i = 0; i < N; ++i) sincosf(in[i], s + i, c + i);
+	});
+
+	// the old sin, with cos(x) = sin(x + pi/2), which is what we used to do
+	report("_mm256_sin_ps twice", [&]() {
+		vecmath::transform(in, s, N, _mm256_sin_ps);
+		vecmath::transform(in, c, N, [](__m256 x) { return _mm256_sin_ps(_mm256_add_ps(x, _mm256_set1_ps(1.57079632679489661923f))); });
+	});
+
+	report("_mm256_sin_ps + _mm256_cos_ps", [&]() {
+		vecmath::transform(in, s, N, [](__m256 x) { __m256 c; return _mm256_sincos_ps(&c, x); });
+		approx_cos(in, c, N);
+	});
+
+	report("_mm256_sincos_ps", [&]() { approx_sincos(in, s, c, N); });
+
+	// big angles, every lane through the Payne-Hanek path. glibc does the same kind of thing there
+	for (int i = 0; i < N; ++i) in[i] = std::ldexp(static_cast<float>(std::rand()) / (RAND_MAX + 1.0f) + 1.0f, 20 + std::rand() % 100);
+
+	report("sincosf (glibc), big", [&]() {
+		for (int i = 0; i < N; ++i) sincosf(in[i], s + i, c + i);
+	});
+
+	report("_mm256_sincos_ps, big", [&]() { approx_sincos(in, s, c, N); });
+
+	// tan only where it's not huge, the absolute error near the poles says nothing
+	for (int i = 0; i < N; ++i) in[i] = -1.5f + static_cast<float>(std::rand()) / (RAND_MAX + 1.0f) * 3.0f;
+
+	bench::result r = suite.run("std::tan", [&]() { for (int i = 0; i < N; ++i) s[i] = std::tan(in[i]); }, N);
+	std::printf("%-30s %s   max abs error %.3g\n", "std::tan", bench::format(r).c_str(), maxErr(in, s, N, ref_tan));
+
+	r = suite.run("_mm256_tan_ps", [&]() { approx_tan(in, s, N); }, N);
+	std::printf("%-30s %s   max abs error %.3g\n", "_mm256_tan_ps", bench::format(r).c_str(), maxErr(in, s, N, ref_tan));
+
+	delete[] in;
+	delete[] s;
+	delete[] c;
+
+	return suite.finish();
+}
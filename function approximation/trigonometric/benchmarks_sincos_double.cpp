@@ -0,0 +1,146 @@
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <x86intrin.h>
+
+#include "sincos_double.hpp"
+#include "../../bench/bench.hpp"
+
+
+
+
+
+using array_func = void (*)(const double*, double*, size_t);
+
+// throughput of whole-array calls, like exponentials/benchmarks_double.cpp. label is what gets
+// printed, name is the whole thing, for the json
+void timeFunc(bench::suite& suite, const std::string& name, const char* label, array_func f, const double* in, double* out, int N) {
+	bench::result r = suite.run(name, [&]() { f(in, out, N); }, N);
+	std::cout << "  Time " << label << ": " << bench::format(r) << "\n";
+}
+
+// max error in ULPs (of the correctly rounded double) against the long double result, and the
+// max relative error, which is what the low degrees are about
+void maxErr(array_func f, long double (*reference)(long double), const double* in, double* out, int N, double& max_ulp, double& max_rel) {
+	f(in, out, N);
+
+	max_ulp = 0.0;
+	max_rel = 0.0;
+	for (int i = 0; i < N; ++i) {
+		long double ref = reference(in[i]);
+		double r = std::abs(static_cast<double>(ref));
+		double ulp = std::nextafter(r, INFINITY) - r;
+
+		double err = static_cast<double>(std::abs(out[i] - ref) / ulp);
+		if (!(err <= max_ulp)) max_ulp = err;
+
+		double rel = static_cast<double>(std::abs((out[i] - ref) / ref));
+		if (!(rel <= max_rel)) max_rel = rel;
+	}
+}
+
+
+
+void std_sin(const double* in, double* out, size_t n) {
+	for (size_t i = 0; i < n; ++i) out[i] = std::sin(in[i]);
+}
+
+void std_cos(const double* in, double* out, size_t n) {
+	for (size_t i = 0; i < n; ++i) out[i] = std::cos(in[i]);
+}
+
+long double ref_sin(long double x) { return std::sin(x); }
+long double ref_cos(long double x) { return std::cos(x); }
+
+// n has to be a multiple of 8 here (N gets rounded down in main)
+template <int Degree, bool Cos>
+void avx2(const double* in, double* out, size_t n) {
+	for (size_t i = 0; i < n; i += 4) {
+		__m256d x = _mm256_loadu_pd(in + i);
+		_mm256_storeu_pd(out + i, Cos ? _mm256_cos_pd<Degree>(x) : _mm256_sin_pd<Degree>(x));
+	}
+}
+
+#ifdef __AVX512F__
+template <int Degree, bool Cos>
+void avx512(const double* in, double* out, size_t n) {
+	for (size_t i = 0; i < n; i += 8) {
+		__m512d x = _mm512_loadu_pd(in + i);
+		_mm512_storeu_pd(out + i, Cos ? _mm512_cos_pd<Degree>(x) : _mm512_sin_pd<Degree>(x));
+	}
+}
+#endif
+
+template <int Degree, bool Cos>
+void scalar(const double* in, double* out, size_t n) {
+	for (size_t i = 0; i < n; ++i) out[i] = Cos ? approx_cos_d<Degree>(in[i]) : approx_sin_d<Degree>(in[i]);
+}
+
+
+
+void reportErr(const char* name, array_func f, long double (*reference)(long double), const double* in, double* out, int N) {
+	double ulp, rel;
+	maxErr(f, reference, in, out, N, ulp, rel);
+	std::cout << "  max error " << name << ": " << ulp << " ULP (relative " << rel << ")\n";
+}
+
+template <int Degree>
+void report(bench::suite& suite, const double* in, const double* big, double* out, int N) {
+	std::string name = "Degree " + std::to_string(Degree);
+	std::cout << "Degree " << Degree << "\n";
+	reportErr("sin", avx2<Degree, false>, ref_sin, in, out, N);
+	reportErr("cos", avx2<Degree, true>, ref_cos, in, out, N);
+	reportErr("sin, |x| up to 2^30", avx2<Degree, false>, ref_sin, big, out, N);
+	timeFunc(suite, name + ", scalar", "scalar", scalar<Degree, false>, in, out, N);
+	timeFunc(suite, name + ", AVX2", "AVX2", avx2<Degree, false>, in, out, N);
+#ifdef __AVX512F__
+	timeFunc(suite, name + ", AVX-512", "AVX-512", avx512<Degree, false>, in, out, N);
+	reportErr("AVX-512 sin", avx512<Degree, false>, ref_sin, in, out, N);
+	reportErr("AVX-512 cos", avx512<Degree, true>, ref_cos, in, out, N);
+#endif
+}
+
+
+
+int main(int argc, char** argv) {
+
+	bench::suite suite("sincos double", argc, argv);
+
+	int N;
+	std::cout << "How many elements? ";
+	std::cin >> N;
+
+	N -= N % 8;
+
+	double* in = new double[N];
+	double* big = new double[N];
+	double* out = new double[N];
+
+	// phases in the thousands, and then big ones, where the reduction has to work for it (but
+	// still under 2^30, above that it's glibc anyway). long double has 11 more bits than double,
+	// so the reference is fine for both
+	std::mt19937_64 gen(42);
+	std::uniform_real_distribution<double> dist(-1000.0, 1000.0);
+	std::uniform_real_distribution<double> big_dist(-1073741824.0, 1073741824.0);
+	for (int i = 0; i < N; ++i) {
+		in[i] = dist(gen);
+		big[i] = big_dist(gen);
+	}
+
+	std::cout << "glibc\n";
+	reportErr("sin", std_sin, ref_sin, in, out, N);
+	reportErr("cos", std_cos, ref_cos, in, out, N);
+	timeFunc(suite, "std::sin", "std::sin", std_sin, in, out, N);
+
+	report<3>(suite, in, big, out, N);
+	report<4>(suite, in, big, out, N);
+	report<5>(suite, in, big, out, N);
+	report<6>(suite, in, big, out, N);
+
+	delete[] in;
+	delete[] big;
+	delete[] out;
+
+	return suite.finish();
+}
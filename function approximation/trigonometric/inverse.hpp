@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <x86intrin.h>
+
+#include "../vecmath/poly.hpp"
+#include "../vecmath/array.hpp"
+
+
+
+// atan, atan2, asin and acos. All of them end up in one of two polynomials:
+//
+// atan: for |x| > 1, atan(x) = pi/2 - atan(1/x), so everything goes to t in [0, 1] with a
+// single division (of min by max, for atan2), and atan(t) = t * P(t^2) with P of degree 7
+//   remez atan 0 1 7 --shift 1 --step 2
+// Cephes splits again at tan(pi/8) for a shorter polynomial, but in SIMD both sides get computed
+// anyway, and a second division costs more than 3 FMAs.
+//
+// asin: for |x| <= 1/2, asin(x) = x * Q(x^2), and above that asin(x) = pi/2 - 2 asin(sqrt(z))
+// with z = (1 - x) / 2, which is in [0, 1/4], so the same Q works for both (like Cephes asinf)
+//   remez asin 0 0.5 5 --shift 1 --step 2
+// degree 5 and not 4 (1.8e-7) because just above 1/2 the subtraction doubles the error of Q.
+// acos is pi/2 - asin for |x| <= 1/2, and 2 asin(sqrt(z)) (or pi minus that, for x < 0) above,
+// so it keeps its relative accuracy near x = 1 where it goes to 0.
+//
+// max relative errors (accuracy/sweep.cpp) are 2.5e-7 for atan (every float), 3.0e-7 for asin
+// and 1.7e-7 for acos, all under 3.5 ULP. atan2 is atan plus exact steps. NaN in gives NaN out,
+// |x| > 1 in asin and acos gives NaN, and atan2 follows the signs of zeros and the infinities
+// like libm (atan2(0, -0) = pi, atan2(inf, inf) = pi/4)
+
+using atan_poly = vecmath::polynomial<9.999998808e-01f, -3.333199024e-01f, 1.996972412e-01f, -1.401948035e-01f, 9.914293140e-02f, -5.948639289e-02f, 2.425240353e-02f, -4.693276249e-03f>;
+using asin_poly = vecmath::polynomial<1.000000000e+00f, 1.666679084e-01f, 7.494434714e-02f, 4.555018619e-02f, 2.385816909e-02f, 4.263564199e-02f>;
+
+// how the polynomials get evaluated (see vecmath/poly.hpp), from benchmark/benchmark.cpp
+static constexpr vecmath::scheme atan_scheme = vecmath::scheme::mixed;
+static constexpr vecmath::scheme asin_scheme = vecmath::scheme::mixed;
+
+static constexpr float PIO2_F = 1.57079632679489661923f;
+static constexpr float PI_F = 3.14159265358979323846f;
+
+
+
+// atan(t) for t in [0, 1]
+template <typename V>
+inline V atan_0_1(V t) {
+	return vecmath::mul(t, atan_poly::eval<atan_scheme>(vecmath::mul(t, t)));
+}
+
+inline float approx_atan(float x) {
+	float a = std::abs(x);
+	bool big = a > 1.0f;
+
+	float r = atan_0_1(big ? 1.0f / a : a);
+	if (big) r = PIO2_F - r;
+
+	return std::copysign(r, x);
+}
+
+inline float approx_atan2(float y, float x) {
+	if (std::isnan(x) || std::isnan(y)) return x + y;
+
+	float ax = std::abs(x), ay = std::abs(y);
+	float mn = std::min(ax, ay), mx = std::max(ax, ay);
+
+	// 0 / 0 and inf / inf, the rest is one division
+	float t = (mx == 0.0f) ? 0.0f : (std::isinf(mn) ? 1.0f : mn / mx);
+
+	float r = atan_0_1(t);
+	if (ay > ax) r = PIO2_F - r;
+	if (std::signbit(x)) r = PI_F - r;
+
+	return std::copysign(r, y);
+}
+
+// asin(a) for a in [0, 1] is s * q, or pi/2 - 2 s q if big. Returns q, s goes in *s. The
+// product is left to the caller, so pi/2 - 2 s q is a single fnmadd (the extra rounding of
+// s * q alone would be 1.2e-7 of error for asin just above 1/2)
+inline float asin_core(float a, float& s, bool& big) {
+	big = a > 0.5f;
+	float z = big ? 0.5f - 0.5f * a : a * a;
+	s = big ? std::sqrt(z) : a;
+	return asin_poly::eval<asin_scheme>(z);
+}
+
+inline float approx_asin(float x) {
+	float s;
+	bool big;
+	float q = asin_core(std::abs(x), s, big);
+	return std::copysign(big ? std::fma(-2.0f * s, q, PIO2_F) : s * q, x);
+}
+
+inline float approx_acos(float x) {
+	float s;
+	bool big;
+	float q = asin_core(std::abs(x), s, big);
+
+	if (!big) return std::fma(-std::copysign(s, x), q, PIO2_F);
+	return std::signbit(x) ? std::fma(-2.0f * s, q, PI_F) : 2.0f * s * q;
+}
+
+
+
+inline __m256 _mm256_atan_ps(__m256 x) {
+	__m256 sign = _mm256_and_ps(x, _mm256_set1_ps(-0.0f));
+	__m256 a = _mm256_xor_ps(x, sign);
+
+	// 1 / inf is 0, so atan(inf) = pi/2 for free
+	__m256 big = _mm256_cmp_ps(a, _mm256_set1_ps(1.0f), _CMP_GT_OQ);
+	__m256 t = _mm256_blendv_ps(a, _mm256_div_ps(_mm256_set1_ps(1.0f), a), big);
+
+	__m256 r = atan_0_1(t);
+	r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PIO2_F), r), big);
+
+	return _mm256_xor_ps(r, sign);
+}
+
+inline __m256 _mm256_atan2_ps(__m256 y, __m256 x) {
+	const __m256 sign_bit = _mm256_set1_ps(-0.0f);
+
+	__m256 ax = _mm256_andnot_ps(sign_bit, x);
+	__m256 ay = _mm256_andnot_ps(sign_bit, y);
+	__m256 mn = _mm256_min_ps(ax, ay);
+	__m256 mx = _mm256_max_ps(ax, ay);
+
+	__m256 t = _mm256_div_ps(mn, mx);
+	t = _mm256_blendv_ps(t, _mm256_setzero_ps(), _mm256_cmp_ps(mx, _mm256_setzero_ps(), _CMP_EQ_OQ));
+	t = _mm256_blendv_ps(t, _mm256_set1_ps(1.0f), _mm256_cmp_ps(mn, _mm256_set1_ps(INFINITY), _CMP_EQ_OQ));
+
+	__m256 r = atan_0_1(t);
+	r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PIO2_F), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+
+	// blendv only looks at the sign bit, so x itself is the mask for x < 0 (and x = -0)
+	r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PI_F), r), x);
+	r = _mm256_or_ps(r, _mm256_and_ps(y, sign_bit));
+
+	// min and max drop NaNs, so put them back
+	return _mm256_blendv_ps(r, _mm256_add_ps(x, y), _mm256_cmp_ps(x, y, _CMP_UNORD_Q));
+}
+
+inline __m256 asin_core(__m256 a, __m256* s, __m256* big) {
+	*big = _mm256_cmp_ps(a, _mm256_set1_ps(0.5f), _CMP_GT_OQ);
+
+	__m256 z_big = _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), a, _mm256_set1_ps(0.5f));
+	__m256 z = _mm256_blendv_ps(_mm256_mul_ps(a, a), z_big, *big);
+	*s = _mm256_blendv_ps(a, _mm256_sqrt_ps(z), *big);
+
+	return asin_poly::eval<asin_scheme>(z);
+}
+
+inline __m256 _mm256_asin_ps(__m256 x) {
+	__m256 sign = _mm256_and_ps(x, _mm256_set1_ps(-0.0f));
+
+	__m256 s, big;
+	__m256 q = asin_core(_mm256_xor_ps(x, sign), &s, &big);
+
+	__m256 r_big = _mm256_fnmadd_ps(_mm256_add_ps(s, s), q, _mm256_set1_ps(PIO2_F));
+	__m256 r = _mm256_blendv_ps(_mm256_mul_ps(s, q), r_big, big);
+
+	return _mm256_xor_ps(r, sign);
+}
+
+inline __m256 _mm256_acos_ps(__m256 x) {
+	__m256 sign = _mm256_and_ps(x, _mm256_set1_ps(-0.0f));
+
+	__m256 s, big;
+	__m256 q = asin_core(_mm256_xor_ps(x, sign), &s, &big);
+
+	// pi/2 - asin(x) for small x, 2 asin(s) or pi - 2 asin(s) for big ones. blendv only looks at
+	// the sign bit, so x itself is the mask for x < 0
+	__m256 r_small = _mm256_fnmadd_ps(_mm256_xor_ps(s, sign), q, _mm256_set1_ps(PIO2_F));
+	__m256 s2 = _mm256_add_ps(s, s);
+	__m256 r_big = _mm256_blendv_ps(_mm256_mul_ps(s2, q), _mm256_fnmadd_ps(s2, q, _mm256_set1_ps(PI_F)), x);
+
+	return _mm256_blendv_ps(r_small, r_big, big);
+}
+
+
+
+// array versions, in-place works too (for atan2, out can be the same as y or x)
+inline void approx_atan(const float* in, float* out, size_t n) {
+	vecmath::transform(in, out, n, _mm256_atan_ps);
+}
+
+inline void approx_asin(const float* in, float* out, size_t n) {
+	vecmath::transform(in, out, n, _mm256_asin_ps);
+}
+
+inline void approx_acos(const float* in, float* out, size_t n) {
+	vecmath::transform(in, out, n, _mm256_acos_ps);
+}
+
+inline void approx_atan2(const float* y, const float* x, float* out, size_t n) {
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		_mm256_storeu_ps(out + i, _mm256_atan2_ps(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i)));
+	}
+
+	if (i < n) {
+		__m256i mask = vecmath::tail_mask(n - i);
+		_mm256_maskstore_ps(out + i, mask, _mm256_atan2_ps(_mm256_maskload_ps(y + i, mask), _mm256_maskload_ps(x + i, mask)));
+	}
+}
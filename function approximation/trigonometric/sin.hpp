@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <bit>
+#include <x86intrin.h>
+
+#include "../vecmath/poly.hpp"
+
+
+
+// sin approximations, in a header so the accuracy sweep (and anything else) can use them
+// without dragging graph.h along. Absolute error is about 1e-3 (see accuracy/sweep.cpp)
+
+// sin(x) ~ x * P(x) on [0, pi), P of degree 3. It used to be written out as a Horner chain of
+// separate multiplications and additions, now it's FMAs in whatever scheme sin_scheme says
+using sin_0_pi_poly = vecmath::polynomial<0.9878554618743378113331828267979221403218f, 0.04891814010265938088474976540346788899839f,
+	-0.2313236245461128278420738316442693697179f, 0.03681629830044755013571431393746576018286f>;
+
+// from benchmark/benchmark.cpp (see vecmath/poly.hpp)
+static constexpr vecmath::scheme sin_scheme = vecmath::scheme::horner;
+
+template <typename V>
+inline V sin_poly_0_pi(V x) {
+	return vecmath::mul(sin_0_pi_poly::eval<sin_scheme>(x), x);
+}
+
+
+inline float approx_sin(float x) {
+	static constexpr float TWO_PI = 6.28318530717958647692f;
+	static constexpr float PI = 3.14159265358979323846f;
+
+	uint32_t sign = std::bit_cast<uint32_t>(x) & 0x80000000;
+
+	x = std::abs(x);
+	x -= TWO_PI * static_cast<float>(static_cast<int>(x * (1.0f / TWO_PI)));
+
+	uint32_t big = x >= PI;
+	x -= PI * big;
+
+	float s = sin_poly_0_pi(x);
+
+	// flip the sign bit (through bit_cast, the old pointer cast broke strict aliasing)
+	return std::bit_cast<float>(std::bit_cast<uint32_t>(s) ^ sign ^ (big << 31));
+}
+
+
+// like 30x faster (!!) than std::sin if bulk calculation is needed. Not too accurate
+inline __m256 _mm256_sin_ps(__m256 x) {
+	static const __m256 TWO_PI = _mm256_set1_ps(6.28318530717958647692f);
+	static const __m256 INV_TWO_PI = _mm256_set1_ps(1.0f / 6.28318530717958647692f);
+	static const __m256 PI = _mm256_set1_ps(3.14159265358979323846f);
+	static const __m256 sign_bit = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+
+	__m256 sign = _mm256_and_ps(x, sign_bit); // extract sign bit
+	x = _mm256_xor_ps(x, sign); // set sign bit to 0 (abs)
+
+	// range reduction to [0, PI]
+	x = _mm256_sub_ps(x, _mm256_mul_ps(TWO_PI, _mm256_floor_ps(_mm256_mul_ps(x, INV_TWO_PI))));
+	__m256 big = _mm256_cmp_ps(x, PI, _CMP_GE_OQ);
+	x = _mm256_sub_ps(x, _mm256_and_ps(PI, big));
+
+	__m256 s = sin_poly_0_pi(x);
+
+	// adjust the sign (sin(x) = -sin(-x) = -sin(x - PI))
+	return _mm256_xor_ps(s, _mm256_xor_ps(sign, _mm256_and_ps(big, sign_bit)));
+}
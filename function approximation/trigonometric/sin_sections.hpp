@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <x86intrin.h>
+
+#include "sincos.hpp"
+#include "../vecmath/array.hpp"
+
+
+
+// the idea from sin.cpp: instead of one degree 4 polynomial for a whole half period
+// (sin_poly_0_pi), split it in sections and use a short polynomial in each. 8 sections and
+// not 9, so a table with one float per section fits in a register, and
+// _mm256_permutevar8x32_ps picks the coefficient of every lane at once (a shuffle, not a
+// gather). Each table row is a coefficient, each column a section.
+//
+// the half period is [-pi/2, pi/2] and not [0, pi): x = k pi + r, sin x = (-1)^k sin r, with
+// the Cody-Waite reduction of sincos.hpp (pi instead of pi/2, good up to |x| = 2^19, no
+// Payne-Hanek here). Near pi the rounding of r alone is 1.2e-7, near pi/2 it doesn't matter
+// because cos is 0 there. Section i is [(i - 4) pi/8, (i - 3) pi/8), and its polynomial is in
+// t = r - center[i] * SECTION, with SECTION = pi/8 rounded to float, so the fnmadd gives t
+// with a single rounding. For the outer sections the center is the middle, i - 3.5, so
+// |t| <= pi/16, and the coefficients are minimax for absolute error around those exact float
+// centers:
+//   remez sin -pi/16 pi/16 <degree> --absolute --offset <(i - 3.5) * SECTION>
+// max error 3.1e-4 for degree 2, 7.6e-6 for degree 3 and 1.7e-7 for degree 4, against 9.7e-4
+// for sin_poly_0_pi. The two sections around 0 are centered on 0 instead, and fitted as
+// t * P(t) with no constant term, so sin(0) is exactly 0 and small x keep their sign, like
+// with the x factor of sin_poly_0_pi:
+//   remez sin 0 pi/8 <degree - 1> --absolute --shift 1
+// max error 3.8e-4, 1.7e-6 and 1.7e-7, and relative error at most |c1 - 1| near 0 (1.1e-2,
+// 7.9e-5 and 1.4e-5). The tables are odd mirrors of themselves, but storing all 8 sections
+// costs nothing and saves a reflection
+
+static constexpr float SIN_SECTION = 0.392699081698724154808f;
+
+// where the polynomial of each section is centered, in units of SIN_SECTION
+static constexpr float SIN_SECTION_CENTER[8] = { -3.5f, -2.5f, -1.5f, 0.0f, 0.0f, 1.5f, 2.5f, 3.5f };
+
+template <int Degree>
+struct sin_sections;
+
+template <> struct sin_sections<2> {
+	static constexpr float c[3][8] = {
+		{ -9.807703495e-01f, -8.314567804e-01f, -5.555616617e-01f, 0.0f, 0.0f, 5.555616617e-01f, 8.314567804e-01f, 9.807703495e-01f },
+		{ 1.941564679e-01f, 5.528987646e-01f, 8.274700642e-01f, 1.010901690e+00f, 1.010901690e+00f, 8.274700642e-01f, 5.528987646e-01f, 1.941564679e-01f },
+		{ 4.884319901e-01f, 4.140682518e-01f, 2.766713202e-01f, 9.024093300e-02f, -9.024093300e-02f, -2.766713202e-01f, -4.140682518e-01f, -4.884319901e-01f },
+	};
+};
+
+template <> struct sin_sections<3> {
+	static constexpr float c[4][8] = {
+		{ -9.807776809e-01f, -8.314632177e-01f, -5.555659533e-01f, 0.0f, 0.0f, 5.555659533e-01f, 8.314632177e-01f, 9.807776809e-01f },
+		{ 1.950890720e-01f, 5.555667877e-01f, 8.314644694e-01f, 1.000079155e+00f, 1.000079155e+00f, 8.314644694e-01f, 5.555667877e-01f, 1.950890720e-01f },
+		{ 4.888191521e-01f, 4.144009352e-01f, 2.768940032e-01f, 1.060303068e-03f, -1.060303068e-03f, -2.768940032e-01f, -4.144009352e-01f, -4.888191521e-01f },
+		{ -3.242114186e-02f, -9.232761711e-02f, -1.381780952e-01f, -1.632282883e-01f, -1.632282883e-01f, -1.381780952e-01f, -9.232761711e-02f, -3.242114186e-02f },
+	};
+};
+
+template <> struct sin_sections<4> {
+	static constexpr float c[5][8] = {
+		{ -9.807853103e-01f, -8.314695954e-01f, -5.555702448e-01f, 0.0f, 0.0f, 5.555702448e-01f, 8.314695954e-01f, 9.807853103e-01f },
+		{ 1.950895339e-01f, 5.555680394e-01f, 8.314663768e-01f, 9.999864101e-01f, 9.999864101e-01f, 8.314663768e-01f, 5.555680394e-01f, 1.950895339e-01f },
+		{ 4.903910160e-01f, 4.157334268e-01f, 2.777841985e-01f, -3.368062607e-04f, 3.368062607e-04f, -2.777841985e-01f, -4.157334268e-01f, -4.903910160e-01f },
+		{ -3.243688494e-02f, -9.237217158e-02f, -1.382447034e-01f, -1.692645550e-01f, -1.692645550e-01f, -1.382447034e-01f, -9.237217158e-02f, -3.243688494e-02f },
+		{ -4.077432305e-02f, -3.456673399e-02f, -2.309675142e-02f, -7.909111679e-03f, 7.909111679e-03f, 2.309675142e-02f, 3.456673399e-02f, 4.077432305e-02f },
+	};
+};
+
+
+
+
+// scalar version, mostly for the sweep
+template <int Degree = 3>
+inline float approx_sin_sections(float x) {
+	static constexpr float INV_PI = 0.318309886183790671538f;
+
+	float k = std::nearbyint(x * INV_PI);
+	float r = x - k * (2.0f * PIO2_1);
+	r -= k * (2.0f * PIO2_2);
+	r -= k * (2.0f * PIO2_3);
+
+	int i = std::clamp(static_cast<int>(std::floor(r * (8.0f * INV_PI))) + 4, 0, 7);
+	float t = r - SIN_SECTION_CENTER[i] * SIN_SECTION;
+
+	const auto& c = sin_sections<Degree>::c;
+	float s = c[Degree][i];
+	for (int j = Degree - 1; j >= 0; --j) s = s * t + c[j][i];
+
+	// odd k flips the sign (k / 2 isn't an integer, fmod is slower than everything else here)
+	float half = 0.5f * k;
+	return half != std::floor(half) ? -s : s;
+}
+
+template <int Degree = 3>
+inline __m256 _mm256_sin_sections_ps(__m256 x) {
+	static constexpr float INV_PI = 0.318309886183790671538f;
+
+	__m256 k = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(INV_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	__m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(2.0f * PIO2_1), x);
+	r = _mm256_fnmadd_ps(k, _mm256_set1_ps(2.0f * PIO2_2), r);
+	r = _mm256_fnmadd_ps(k, _mm256_set1_ps(2.0f * PIO2_3), r);
+
+	// section of every lane, clamped because r can be a tiny bit out of [-pi/2, pi/2]
+	__m256 section = _mm256_floor_ps(_mm256_fmadd_ps(r, _mm256_set1_ps(8.0f * INV_PI), _mm256_set1_ps(4.0f)));
+	section = _mm256_min_ps(_mm256_max_ps(section, _mm256_setzero_ps()), _mm256_set1_ps(7.0f));
+	__m256i i = _mm256_cvtps_epi32(section);
+
+	__m256 center = _mm256_permutevar8x32_ps(_mm256_loadu_ps(SIN_SECTION_CENTER), i);
+	__m256 t = _mm256_fnmadd_ps(center, _mm256_set1_ps(SIN_SECTION), r);
+
+	// Horner with the coefficients of each lane's section. The tables are constants, so the
+	// loads get hoisted out of the loops that call this
+	const auto& c = sin_sections<Degree>::c;
+	__m256 s = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c[Degree]), i);
+	#pragma GCC unroll 8
+	for (int j = Degree - 1; j >= 0; --j) s = _mm256_fmadd_ps(s, t, _mm256_permutevar8x32_ps(_mm256_loadu_ps(c[j]), i));
+
+	__m256 sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtps_epi32(k), 31));
+	return _mm256_xor_ps(s, sign);
+}
+
+// array version, in-place works too
+template <int Degree = 3>
+inline void approx_sin_sections(const float* in, float* out, size_t n) {
+	vecmath::transform(in, out, n, _mm256_sin_sections_ps<Degree>);
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <bit>
+#include <x86intrin.h>
+
+#include "../vecmath/array.hpp"
+
+
+
+// sin, cos and tan from a single range reduction. Unlike approx_sin (reduce to [0, pi) and
+// one polynomial there), x is reduced to r in [-pi/4, pi/4] with x = k * pi/2 + r, and
+// sin(r) and cos(r) are both computed there. Depending on the quadrant q = k mod 4:
+//   q = 0: sin x = sin r,  cos x = cos r
+//   q = 1: sin x = cos r,  cos x = -sin r
+//   q = 2: sin x = -sin r, cos x = -cos r
+//   q = 3: sin x = -cos r, cos x = sin r
+// so sincos costs one reduction and two short polynomials, and sin or cos alone aren't much
+// cheaper. The polynomials are the minimax ones from Cephes (sinf/cosf), about 1 ULP on
+// [-pi/4, pi/4], so the max error is about 6e-8 absolute where the reduction is exact.
+//
+// the reduction is Cody-Waite: pi/2 split in 3 parts, subtracted one at a time with FMAs.
+// That's good up to |x| = 2^19. After that k = round(x * 2/pi), computed in float, starts
+// picking the wrong quadrant near the edges, so r goes past pi/4 where the polynomials aren't
+// made for it (|r| up to 0.88 and an error of 1.2e-7 at 2^20, 1.15 and 3e-6 at 2^22), and
+// past 2^24 k itself can't be computed in float. So lanes with |x| > 2^19 (never, for phases
+// that stay in the thousands) get found with a movemask and go to Payne-Hanek
+// (reduce_pio2_large), one at a time in scalar code. That's slow, but it's right for every
+// float, and the common case only pays for a compare and a branch
+
+static constexpr float PIO2_1 = 1.5703125f;
+static constexpr float PIO2_2 = 4.837512969970703125e-4f;
+static constexpr float PIO2_3 = 7.54978995489188216e-8f;
+static constexpr float TWO_OVER_PI = 0.636619772367581343f;
+
+// above this the Cody-Waite reduction isn't good enough
+static constexpr float REDUCE_LARGE = 524288.0f;
+
+// 2/pi in binary, 32 bits at a time, with a word of zeros in front so x down to 2^-7 works
+static constexpr uint32_t TWO_OVER_PI_BITS[] = {
+	0x00000000, 0xA2F9836E, 0x4E441529, 0xFC2757D1, 0xF534DDC0, 0xDB629599, 0x3C439041, 0xFE5163AB, 0xDEBBC561
+};
+
+// Payne-Hanek: x = q * pi/2 + r for any finite float, r in [-pi/4, pi/4]. With |x| = m * 2^e
+// (m the 24 bit mantissa as an integer), x * 2/pi = sum over the bits b_i of 2/pi of
+// m * b_i * 2^(e - i), and every term with e - i >= 2 is a multiple of 4, which doesn't change
+// the quadrant or r. So only 96 bits of 2/pi starting at bit e - 1 are needed, whatever the
+// size of x: their product with m, mod 2^96, is x * 2/pi mod 4 as a fixed point number with 94
+// fractional bits. Rounding that to the nearest integer gives q, and what's left is r / (pi/2)
+inline float reduce_pio2_large(float x, int& q) {
+	if (!std::isfinite(x)) {
+		q = 0;
+		return x - x;
+	}
+
+	uint32_t bits = std::bit_cast<uint32_t>(x);
+	int e = static_cast<int>((bits >> 23) & 0xff) - 150;
+	uint64_t m = (bits & 0x7fffff) | 0x800000;
+
+	// bit e - 1 of 2/pi (counting from 1 after the point) is bit e + 30 of the table
+	int p = e + 30;
+	int w = p / 32, shift = p % 32;
+
+	unsigned __int128 window = 0;
+	for (int k = 0; k < 4; ++k) window = (window << 32) | TWO_OVER_PI_BITS[w + k];
+	window = (window << shift) >> 32;
+
+	unsigned __int128 mask96 = (static_cast<unsigned __int128>(1) << 96) - 1;
+	unsigned __int128 y = (m * window) & mask96;
+
+	// round to the nearest quadrant: after adding half a unit the top 2 bits are q, and the
+	// other 94 minus that half are the signed fraction, r / (pi/2) in [-1/2, 1/2). 64 bits of
+	// it are plenty for a float
+	unsigned __int128 half = static_cast<unsigned __int128>(1) << 93;
+	unsigned __int128 rounded = (y + half) & mask96;
+	int k = static_cast<int>(rounded >> 94);
+
+	uint64_t fraction = static_cast<uint64_t>(rounded >> 30) - (uint64_t(1) << 63);
+	double r = static_cast<double>(static_cast<int64_t>(fraction)) * 0x1p-64 * 1.57079632679489661923;
+
+	if (bits >> 31) {
+		q = -k;
+		return static_cast<float>(-r);
+	}
+	q = k;
+	return static_cast<float>(r);
+}
+
+
+
+inline float sin_poly_pio4(float r) {
+	float r2 = r * r;
+	float p = (-1.9515295891e-4f * r2 + 8.3321608736e-3f) * r2 - 1.6666654611e-1f;
+	return (p * r2) * r + r;
+}
+
+inline float cos_poly_pio4(float r) {
+	float r2 = r * r;
+	float p = (2.443315711809948e-5f * r2 - 1.388731625493765e-3f) * r2 + 4.166664568298827e-2f;
+	return (p * r2) * r2 - 0.5f * r2 + 1.0f;
+}
+
+inline void approx_sincos(float x, float& s, float& c) {
+	float r;
+	int q;
+	if (std::abs(x) <= REDUCE_LARGE) {
+		float k = std::nearbyint(x * TWO_OVER_PI);
+		q = static_cast<int>(k);
+
+		r = x - k * PIO2_1;
+		r -= k * PIO2_2;
+		r -= k * PIO2_3;
+	}
+	else r = reduce_pio2_large(x, q);
+
+	float sr = sin_poly_pio4(r);
+	float cr = cos_poly_pio4(r);
+
+	// q & 1 swaps them, and the sign of sin flips for q = 2, 3 and the one of cos for q = 1, 2
+	float s_q = (q & 1) ? cr : sr;
+	float c_q = (q & 1) ? sr : cr;
+
+	s = std::bit_cast<float>(std::bit_cast<uint32_t>(s_q) ^ ((static_cast<uint32_t>(q) & 2) << 30));
+	c = std::bit_cast<float>(std::bit_cast<uint32_t>(c_q) ^ ((static_cast<uint32_t>(q + 1) & 2) << 30));
+}
+
+inline float approx_cos(float x) {
+	float s, c;
+	approx_sincos(x, s, c);
+	return c;
+}
+
+inline float approx_tan(float x) {
+	float s, c;
+	approx_sincos(x, s, c);
+	return s / c;
+}
+
+
+
+// redoes the lanes of r and q set in mask with reduce_pio2_large. Not inlined: with the arrays
+// on the stack in every loop that uses the reduction, the fast path got 50% slower
+[[gnu::noinline]] inline void reduce_pio2_lanes(__m256 x, __m256* r, __m256i* q, int mask) {
+	alignas(32) float xs[8], rs[8];
+	alignas(32) int qs[8];
+	_mm256_store_ps(xs, x);
+	_mm256_store_ps(rs, *r);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(qs), *q);
+
+	while (mask) {
+		int lane = std::countr_zero(static_cast<unsigned>(mask));
+		rs[lane] = reduce_pio2_large(xs[lane], qs[lane]);
+		mask &= mask - 1;
+	}
+
+	*r = _mm256_load_ps(rs);
+	*q = _mm256_load_si256(reinterpret_cast<const __m256i*>(qs));
+}
+
+// x = k * pi/2 + r, returns r and puts k in q (only the low 2 bits matter)
+inline __m256 _mm256_reduce_pio2_ps(__m256 x, __m256i* q) {
+	__m256 k = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	*q = _mm256_cvtps_epi32(k);
+
+	__m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(PIO2_1), x);
+	r = _mm256_fnmadd_ps(k, _mm256_set1_ps(PIO2_2), r);
+	r = _mm256_fnmadd_ps(k, _mm256_set1_ps(PIO2_3), r);
+
+	// the lanes Cody-Waite can't do (NaN and inf too, the compare is unordered-true) get redone
+	// one at a time. The branch is almost never taken, so it's almost free
+	__m256 abs_x = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+	int big = _mm256_movemask_ps(_mm256_cmp_ps(abs_x, _mm256_set1_ps(REDUCE_LARGE), _CMP_NLE_UQ));
+	if (big) [[unlikely]] reduce_pio2_lanes(x, &r, q, big);
+
+	return r;
+}
+
+// returns sin(x) and stores cos(x) in *c (same argument order as the SVML one)
+inline __m256 _mm256_sincos_ps(__m256* c, __m256 x) {
+	__m256i q;
+	__m256 r = _mm256_reduce_pio2_ps(x, &q);
+	__m256 r2 = _mm256_mul_ps(r, r);
+
+	// both polynomials in the same pass, the two chains are independent
+	__m256 ps = _mm256_fmadd_ps(_mm256_set1_ps(-1.9515295891e-4f), r2, _mm256_set1_ps(8.3321608736e-3f));
+	__m256 pc = _mm256_fmadd_ps(_mm256_set1_ps(2.443315711809948e-5f), r2, _mm256_set1_ps(-1.388731625493765e-3f));
+	ps = _mm256_fmadd_ps(ps, r2, _mm256_set1_ps(-1.6666654611e-1f));
+	pc = _mm256_fmadd_ps(pc, r2, _mm256_set1_ps(4.166664568298827e-2f));
+
+	__m256 sr = _mm256_fmadd_ps(_mm256_mul_ps(ps, r2), r, r);
+	__m256 cr = _mm256_fmadd_ps(_mm256_mul_ps(pc, r2), r2, _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), r2, _mm256_set1_ps(1.0f)));
+
+	// lanes with q odd swap sin and cos, and the signs come from bit 1 of q and q + 1
+	__m256 swap = _mm256_castsi256_ps(_mm256_slli_epi32(q, 31));
+	__m256 s_q = _mm256_blendv_ps(sr, cr, swap);
+	__m256 c_q = _mm256_blendv_ps(cr, sr, swap);
+
+	__m256 s_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), 30));
+	__m256 c_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+
+	*c = _mm256_xor_ps(c_q, c_sign);
+	return _mm256_xor_ps(s_q, s_sign);
+}
+
+inline __m256 _mm256_cos_ps(__m256 x) {
+	__m256 c;
+	_mm256_sincos_ps(&c, x);
+	return c;
+}
+
+inline __m256 _mm256_tan_ps(__m256 x) {
+	__m256 c;
+	__m256 s = _mm256_sincos_ps(&c, x);
+	return _mm256_div_ps(s, c);
+}
+
+
+
+// array versions, in-place works too (for sincos, in can be the same as s or c)
+inline void approx_sincos(const float* in, float* s, float* c, size_t n) {
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256 vc;
+		__m256 vs = _mm256_sincos_ps(&vc, _mm256_loadu_ps(in + i));
+		_mm256_storeu_ps(s + i, vs);
+		_mm256_storeu_ps(c + i, vc);
+	}
+
+	if (i < n) {
+		__m256i mask = vecmath::tail_mask(n - i);
+		__m256 vc;
+		__m256 vs = _mm256_sincos_ps(&vc, _mm256_maskload_ps(in + i, mask));
+		_mm256_maskstore_ps(s + i, mask, vs);
+		_mm256_maskstore_ps(c + i, mask, vc);
+	}
+}
+
+inline void approx_cos(const float* in, float* out, size_t n) {
+	vecmath::transform(in, out, n, _mm256_cos_ps);
+}
+
+inline void approx_tan(const float* in, float* out, size_t n) {
+	vecmath::transform(in, out, n, _mm256_tan_ps);
+}
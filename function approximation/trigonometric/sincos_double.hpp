@@ -0,0 +1,351 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <bit>
+#include <x86intrin.h>
+
+
+
+// double precision sin and cos, for double, __m256d and __m512d. Same idea as sincos.hpp:
+// x = k * pi/2 + r with |r| <= pi/4, sin(r) and cos(r) are both polynomials in r^2, and the
+// quadrant k mod 4 picks which one goes where and with which sign. Degree is the degree of
+// the polynomials in r^2, and it's the accuracy knob (max errors against long double, on
+// |x| < 1000, from benchmarks_sincos_double.cpp):
+//   Degree 3: 3.3e-8 relative, for when the float versions would do but the data is double
+//   Degree 4: 5.6e-11
+//   Degree 5: 6.6e-14
+//   Degree 6: 1.3 ULP (the default, glibc is 0.51)
+// the coefficients are minimax for relative error on [0, pi/4], from
+//   remez sin 0 pi/4 <Degree> --shift 1 --step 2 --double
+//   remez cos 0 pi/4 <Degree> --step 2 --double
+// except cos at Degree 6: there the fitted constant rounds to 1 - 2^-53, which alone is an ULP
+// near r = 0, so it's 1 + r^2 * P(r^2) with P minimax for the absolute error of cos - 1:
+//   remez cosm1 0 pi/4 5 --shift 2 --step 2 --absolute --double
+// (that fit is a bit worse than the relative one for the lower degrees, so they keep theirs)
+//
+// the reduction is Cody-Waite with pi/2 split in 3 doubles (159 bits), and r comes out as a
+// double-word r_hi + r_lo. Rounding r to a single double would cost up to half an ULP of r
+// before the polynomial even starts, so r_lo goes into the small terms instead:
+//   sin(r_hi + r_lo) ~ sin(r_hi) + r_lo * (1 - r_hi^2 / 2),  cos(r_hi + r_lo) ~ cos(r_hi) - r_lo * r_hi
+// and the last step of each is a single rounding of (main term + small terms). For cos the
+// main term is h = 1 - r^2 / 2 and not the constant of the polynomial, with the rounding error
+// of h moved to the small terms (1 - h is exact), otherwise cos alone is 2 ULP. k * P1 is exact
+// with an FMA for any k, so this works up to |x| = 2^30, and bigger lanes (and inf, NaN) are
+// found with a movemask and given to std::sin and std::cos one at a time
+
+template <int Degree> struct sincos_double_coeffs;
+
+template <> struct sincos_double_coeffs<3> {
+	static constexpr double sin[] = { 9.99999996761798071e-01, -1.66666502242396458e-01, 8.33201645306588974e-03, -1.95018220138899767e-04 };
+	static constexpr double cos[] = { 9.99999967386286603e-01, -4.99998424342130321e-01, 4.16544195617641194e-02, -1.35794040797268837e-03 };
+};
+template <> struct sincos_double_coeffs<4> {
+	static constexpr double sin[] = { 9.99999999995450306e-01, -1.66666666304461780e-01, 8.33332869015201462e-03, -1.98391783558727903e-04, 2.71715281048358310e-06 };
+	static constexpr double cos[] = { 9.99999999943937290e-01, -4.99999995715568579e-01, 4.16666132334736414e-02, -1.38865291471458401e-03, 2.43726791772351564e-05 };
+};
+template <> struct sincos_double_coeffs<5> {
+	static constexpr double sin[] = { 9.99999999999995448e-01, -1.66666666666148933e-01, 8.33333332364684723e-03, -1.98412631937728000e-04, 2.75552525625006514e-06, -2.47553078631476276e-08 };
+	static constexpr double cos[] = { 9.99999999999934386e-01, -4.99999999992712496e-01, 4.16666665336906591e-02, -1.38888799342581307e-03, 2.47988442279502482e-05, -2.71679791884196668e-07 };
+};
+template <> struct sincos_double_coeffs<6> {
+	static constexpr double sin[] = { 1.00000000000000000e+00, -1.66666666666666158e-01, 8.33333333332005217e-03, -1.98412698284415340e-04, 2.75573133125189657e-06, -2.50507079199965106e-08, 1.58942534603916369e-10 };
+	static constexpr double cos[] = { 1.0, -4.99999999999994837e-01, 4.16666666665031910e-02, -1.38888888717260384e-03, 2.48015790160525711e-05, -2.75552963013528126e-07, 2.06335859895748004e-09 };
+};
+
+// what cos has on top of 1 - z/2: the constant and z terms of the fit aren't exactly 1 and
+// -1/2, and these differences are exact doubles
+template <int Degree> static constexpr double cos_c0_tail = sincos_double_coeffs<Degree>::cos[0] - 1.0;
+template <int Degree> static constexpr double cos_c1_tail = sincos_double_coeffs<Degree>::cos[1] + 0.5;
+
+// pi/2 = PIO2_1D + PIO2_2D + PIO2_3D, each rounded to double from what's left
+static constexpr double PIO2_1D = 1.5707963267948966;
+static constexpr double PIO2_2D = 6.123233995736766e-17;
+static constexpr double PIO2_3D = -1.4973849048591698e-33;
+static constexpr double TWO_OVER_PI_D = 0.6366197723675814;
+
+// adding 1.5 * 2^52 rounds to an integer and leaves k in the low bits (like exp_double.hpp)
+static constexpr double SINCOS_ROUND_MAGIC = 6755399441055744.0;
+static constexpr double REDUCE_LARGE_D = 1073741824.0;
+
+
+
+inline void approx_sincos_reduce(double x, double& hi, double& lo, int& q) {
+	double t = std::fma(x, TWO_OVER_PI_D, SINCOS_ROUND_MAGIC);
+	double k = t - SINCOS_ROUND_MAGIC;
+	q = static_cast<int>(std::bit_cast<uint64_t>(t) & 3);
+
+	// r1 is exact. w = k * P2 with its rounding error w_lo, then r1 - w as a double-word
+	double r1 = std::fma(-k, PIO2_1D, x);
+	double w = k * PIO2_2D;
+	double w_lo = std::fma(k, PIO2_2D, -w);
+
+	hi = r1 - w;
+	lo = ((r1 - hi) - w) - std::fma(k, PIO2_3D, w_lo);
+}
+
+template <int Degree = 6>
+inline void approx_sincos_d(double x, double& s, double& c) {
+	if (!(std::abs(x) <= REDUCE_LARGE_D)) {
+		s = std::sin(x);
+		c = std::cos(x);
+		return;
+	}
+
+	double hi, lo;
+	int q;
+	approx_sincos_reduce(x, hi, lo, q);
+
+	const double* cs = sincos_double_coeffs<Degree>::sin;
+	const double* cc = sincos_double_coeffs<Degree>::cos;
+
+	double z = hi * hi;
+	double ps = cs[Degree], pc = cc[Degree];
+	#pragma GCC unroll 8
+	for (int k = Degree - 1; k > 0; --k) ps = std::fma(ps, z, cs[k]);
+	#pragma GCC unroll 8
+	for (int k = Degree - 1; k > 1; --k) pc = std::fma(pc, z, cc[k]);
+
+	// 1 - z/2 and its rounding error e are exact, so cos is h plus everything small
+	double h = std::fma(-0.5, z, 1.0);
+	double e = std::fma(-0.5, z, 1.0 - h);
+	double cos_small = std::fma(z * z, pc, std::fma(z, cos_c1_tail<Degree>, cos_c0_tail<Degree> + e)) - hi * lo;
+
+	double sr = std::fma(hi, cs[0], std::fma(hi * z, ps, lo * h));
+	double cr = h + cos_small;
+
+	double s_q = (q & 1) ? cr : sr;
+	double c_q = (q & 1) ? sr : cr;
+
+	s = (q & 2) ? -s_q : s_q;
+	c = ((q + 1) & 2) ? -c_q : c_q;
+}
+
+template <int Degree = 6>
+inline double approx_sin_d(double x) {
+	double s, c;
+	approx_sincos_d<Degree>(x, s, c);
+	return s;
+}
+
+template <int Degree = 6>
+inline double approx_cos_d(double x) {
+	double s, c;
+	approx_sincos_d<Degree>(x, s, c);
+	return c;
+}
+
+
+
+// the lanes of s and c set in mask from std::sin and std::cos. Not inlined, like
+// reduce_pio2_lanes in sincos.hpp, so the common case doesn't pay for the stack arrays
+[[gnu::noinline]] inline void sincos_large_lanes(const double* x, double* s, double* c, int mask) {
+	while (mask) {
+		int lane = std::countr_zero(static_cast<unsigned>(mask));
+		s[lane] = std::sin(x[lane]);
+		c[lane] = std::cos(x[lane]);
+		mask &= mask - 1;
+	}
+}
+
+[[gnu::noinline]] inline void sincos_large_lanes(__m256d x, __m256d* s, __m256d* c, int mask) {
+	alignas(32) double xs[4], ss[4], cs[4];
+	_mm256_store_pd(xs, x);
+	_mm256_store_pd(ss, *s);
+	_mm256_store_pd(cs, *c);
+	sincos_large_lanes(xs, ss, cs, mask);
+	*s = _mm256_load_pd(ss);
+	*c = _mm256_load_pd(cs);
+}
+
+// returns sin(x) and stores cos(x) in *c
+template <int Degree = 6>
+inline __m256d _mm256_sincos_pd(__m256d* c, __m256d x) {
+	const __m256d magic = _mm256_set1_pd(SINCOS_ROUND_MAGIC);
+
+	__m256d t = _mm256_fmadd_pd(x, _mm256_set1_pd(TWO_OVER_PI_D), magic);
+	__m256d k = _mm256_sub_pd(t, magic);
+
+	__m256d r1 = _mm256_fnmadd_pd(k, _mm256_set1_pd(PIO2_1D), x);
+	__m256d w = _mm256_mul_pd(k, _mm256_set1_pd(PIO2_2D));
+	__m256d w_lo = _mm256_fmsub_pd(k, _mm256_set1_pd(PIO2_2D), w);
+
+	__m256d hi = _mm256_sub_pd(r1, w);
+	__m256d lo = _mm256_sub_pd(_mm256_sub_pd(_mm256_sub_pd(r1, hi), w), _mm256_fmadd_pd(k, _mm256_set1_pd(PIO2_3D), w_lo));
+
+	const double* cs = sincos_double_coeffs<Degree>::sin;
+	const double* cc = sincos_double_coeffs<Degree>::cos;
+
+	__m256d z = _mm256_mul_pd(hi, hi);
+	__m256d ps = _mm256_set1_pd(cs[Degree]), pc = _mm256_set1_pd(cc[Degree]);
+	#pragma GCC unroll 8
+	for (int j = Degree - 1; j > 0; --j) ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(cs[j]));
+	#pragma GCC unroll 8
+	for (int j = Degree - 1; j > 1; --j) pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(cc[j]));
+
+	const __m256d half = _mm256_set1_pd(0.5), one = _mm256_set1_pd(1.0);
+	__m256d h = _mm256_fnmadd_pd(half, z, one);
+	__m256d e = _mm256_fnmadd_pd(half, z, _mm256_sub_pd(one, h));
+	__m256d cos_small = _mm256_fmadd_pd(z, _mm256_set1_pd(cos_c1_tail<Degree>), _mm256_add_pd(_mm256_set1_pd(cos_c0_tail<Degree>), e));
+	cos_small = _mm256_fnmadd_pd(hi, lo, _mm256_fmadd_pd(_mm256_mul_pd(z, z), pc, cos_small));
+
+	__m256d sin_small = _mm256_fmadd_pd(_mm256_mul_pd(hi, z), ps, _mm256_mul_pd(lo, h));
+	__m256d sr = _mm256_fmadd_pd(hi, _mm256_set1_pd(cs[0]), sin_small);
+	__m256d cr = _mm256_add_pd(h, cos_small);
+
+	// q is in the low bits of t: bit 0 swaps, bit 1 of q and of q + 1 are the signs
+	__m256i q = _mm256_castpd_si256(t);
+	__m256d swap = _mm256_castsi256_pd(_mm256_slli_epi64(q, 63));
+	__m256d s_q = _mm256_blendv_pd(sr, cr, swap);
+	__m256d c_q = _mm256_blendv_pd(cr, sr, swap);
+
+	const __m256i sign_bit = _mm256_set1_epi64x(0x8000000000000000);
+	__m256d s_sign = _mm256_castsi256_pd(_mm256_and_si256(_mm256_slli_epi64(q, 62), sign_bit));
+	__m256d c_sign = _mm256_castsi256_pd(_mm256_and_si256(_mm256_slli_epi64(_mm256_add_epi64(q, _mm256_set1_epi64x(1)), 62), sign_bit));
+
+	__m256d s = _mm256_xor_pd(s_q, s_sign);
+	*c = _mm256_xor_pd(c_q, c_sign);
+
+	__m256d abs_x = _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+	int big = _mm256_movemask_pd(_mm256_cmp_pd(abs_x, _mm256_set1_pd(REDUCE_LARGE_D), _CMP_NLE_UQ));
+	if (big) [[unlikely]] sincos_large_lanes(x, &s, c, big);
+
+	return s;
+}
+
+template <int Degree = 6>
+inline __m256d _mm256_sin_pd(__m256d x) {
+	__m256d c;
+	return _mm256_sincos_pd<Degree>(&c, x);
+}
+
+template <int Degree = 6>
+inline __m256d _mm256_cos_pd(__m256d x) {
+	__m256d c;
+	_mm256_sincos_pd<Degree>(&c, x);
+	return c;
+}
+
+
+
+#ifdef __AVX512F__
+[[gnu::noinline]] inline void sincos_large_lanes(__m512d x, __m512d* s, __m512d* c, int mask) {
+	alignas(64) double xs[8], ss[8], cs[8];
+	_mm512_store_pd(xs, x);
+	_mm512_store_pd(ss, *s);
+	_mm512_store_pd(cs, *c);
+	sincos_large_lanes(xs, ss, cs, mask);
+	*s = _mm512_load_pd(ss);
+	*c = _mm512_load_pd(cs);
+}
+
+template <int Degree = 6>
+inline __m512d _mm512_sincos_pd(__m512d* c, __m512d x) {
+	const __m512d magic = _mm512_set1_pd(SINCOS_ROUND_MAGIC);
+
+	__m512d t = _mm512_fmadd_pd(x, _mm512_set1_pd(TWO_OVER_PI_D), magic);
+	__m512d k = _mm512_sub_pd(t, magic);
+
+	__m512d r1 = _mm512_fnmadd_pd(k, _mm512_set1_pd(PIO2_1D), x);
+	__m512d w = _mm512_mul_pd(k, _mm512_set1_pd(PIO2_2D));
+	__m512d w_lo = _mm512_fmsub_pd(k, _mm512_set1_pd(PIO2_2D), w);
+
+	__m512d hi = _mm512_sub_pd(r1, w);
+	__m512d lo = _mm512_sub_pd(_mm512_sub_pd(_mm512_sub_pd(r1, hi), w), _mm512_fmadd_pd(k, _mm512_set1_pd(PIO2_3D), w_lo));
+
+	const double* cs = sincos_double_coeffs<Degree>::sin;
+	const double* cc = sincos_double_coeffs<Degree>::cos;
+
+	__m512d z = _mm512_mul_pd(hi, hi);
+	__m512d ps = _mm512_set1_pd(cs[Degree]), pc = _mm512_set1_pd(cc[Degree]);
+	#pragma GCC unroll 8
+	for (int j = Degree - 1; j > 0; --j) ps = _mm512_fmadd_pd(ps, z, _mm512_set1_pd(cs[j]));
+	#pragma GCC unroll 8
+	for (int j = Degree - 1; j > 1; --j) pc = _mm512_fmadd_pd(pc, z, _mm512_set1_pd(cc[j]));
+
+	const __m512d half = _mm512_set1_pd(0.5), one = _mm512_set1_pd(1.0);
+	__m512d h = _mm512_fnmadd_pd(half, z, one);
+	__m512d e = _mm512_fnmadd_pd(half, z, _mm512_sub_pd(one, h));
+	__m512d cos_small = _mm512_fmadd_pd(z, _mm512_set1_pd(cos_c1_tail<Degree>), _mm512_add_pd(_mm512_set1_pd(cos_c0_tail<Degree>), e));
+	cos_small = _mm512_fnmadd_pd(hi, lo, _mm512_fmadd_pd(_mm512_mul_pd(z, z), pc, cos_small));
+
+	__m512d sin_small = _mm512_fmadd_pd(_mm512_mul_pd(hi, z), ps, _mm512_mul_pd(lo, h));
+	__m512d sr = _mm512_fmadd_pd(hi, _mm512_set1_pd(cs[0]), sin_small);
+	__m512d cr = _mm512_add_pd(h, cos_small);
+
+	// masks instead of blendv, and the signs go in with a masked xor
+	__m512i q = _mm512_castpd_si512(t);
+	__mmask8 swap = _mm512_test_epi64_mask(q, _mm512_set1_epi64(1));
+	__mmask8 s_neg = _mm512_test_epi64_mask(q, _mm512_set1_epi64(2));
+	__mmask8 c_neg = _mm512_test_epi64_mask(_mm512_add_epi64(q, _mm512_set1_epi64(1)), _mm512_set1_epi64(2));
+
+	__m512d s = _mm512_mask_blend_pd(swap, sr, cr);
+	__m512d cq = _mm512_mask_blend_pd(swap, cr, sr);
+
+	const __m512d sign_bit = _mm512_set1_pd(-0.0);
+	s = _mm512_mask_xor_pd(s, s_neg, s, sign_bit);
+	*c = _mm512_mask_xor_pd(cq, c_neg, cq, sign_bit);
+
+	__mmask8 big = _mm512_cmp_pd_mask(_mm512_abs_pd(x), _mm512_set1_pd(REDUCE_LARGE_D), _CMP_NLE_UQ);
+	if (big) [[unlikely]] sincos_large_lanes(x, &s, c, big);
+
+	return s;
+}
+
+template <int Degree = 6>
+inline __m512d _mm512_sin_pd(__m512d x) {
+	__m512d c;
+	return _mm512_sincos_pd<Degree>(&c, x);
+}
+
+template <int Degree = 6>
+inline __m512d _mm512_cos_pd(__m512d x) {
+	__m512d c;
+	_mm512_sincos_pd<Degree>(&c, x);
+	return c;
+}
+#endif
+
+
+
+// array versions, AVX-512 when it's enabled and AVX2 otherwise, the tail in scalar code.
+// in-place works too (for sincos, in can be the same as s or c)
+template <int Degree = 6>
+inline void approx_sincos_d(const double* in, double* s, double* c, size_t n) {
+	size_t i = 0;
+#ifdef __AVX512F__
+	for (; i + 8 <= n; i += 8) {
+		__m512d vc;
+		__m512d vs = _mm512_sincos_pd<Degree>(&vc, _mm512_loadu_pd(in + i));
+		_mm512_storeu_pd(s + i, vs);
+		_mm512_storeu_pd(c + i, vc);
+	}
+#endif
+	for (; i + 4 <= n; i += 4) {
+		__m256d vc;
+		__m256d vs = _mm256_sincos_pd<Degree>(&vc, _mm256_loadu_pd(in + i));
+		_mm256_storeu_pd(s + i, vs);
+		_mm256_storeu_pd(c + i, vc);
+	}
+	for (; i < n; ++i) approx_sincos_d<Degree>(in[i], s[i], c[i]);
+}
+
+template <int Degree = 6>
+inline void approx_sin_d(const double* in, double* out, size_t n) {
+	size_t i = 0;
+#ifdef __AVX512F__
+	for (; i + 8 <= n; i += 8) _mm512_storeu_pd(out + i, _mm512_sin_pd<Degree>(_mm512_loadu_pd(in + i)));
+#endif
+	for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_sin_pd<Degree>(_mm256_loadu_pd(in + i)));
+	for (; i < n; ++i) out[i] = approx_sin_d<Degree>(in[i]);
+}
+
+template <int Degree = 6>
+inline void approx_cos_d(const double* in, double* out, size_t n) {
+	size_t i = 0;
+#ifdef __AVX512F__
+	for (; i + 8 <= n; i += 8) _mm512_storeu_pd(out + i, _mm512_cos_pd<Degree>(_mm512_loadu_pd(in + i)));
+#endif
+	for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_cos_pd<Degree>(_mm256_loadu_pd(in + i)));
+	for (; i < n; ++i) out[i] = approx_cos_d<Degree>(in[i]);
+}
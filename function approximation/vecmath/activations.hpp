@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cfloat>
+
+#include "common.hpp"
+#include "exp.hpp"
+#include "array.hpp"
+
+
+
+// neural network activations built on exp2_safe, with the same Degree parameter (2 to 5) as
+// the rest of vecmath. The element-wise ones have float, __m256 and __m512 overloads and array
+// versions, softmax works on whole rows (AVX2). All of them use the safe exp, so big inputs
+// saturate to the right value instead of going through 2^i garbage: sigmoid(-100) is 0 and
+// sigmoid(100) is 1. NaN stays NaN, and -inf only works for sigmoid and tanh (SiLU and GELU
+// end up with -inf / inf there)
+
+namespace vecmath {
+
+// 1 / (1 + e^-x)
+template <int Degree = 5, typename V>
+inline V sigmoid(V x) {
+	const V one = broadcast<V>(1.0f);
+	return div(one, add(one, exp_safe<Degree>(sub(broadcast<V>(0.0f), x))));
+}
+
+// x * sigmoid(x), written as x / (1 + e^-x) to save the multiplication
+template <int Degree = 5, typename V>
+inline V silu(V x) {
+	return div(x, add(broadcast<V>(1.0f), exp_safe<Degree>(sub(broadcast<V>(0.0f), x))));
+}
+
+// tanh(x) = (e^2x - 1) / (e^2x + 1), with expm1 so that small x keep their relative precision
+// (1 - 2 / (e^2x + 1) cancels everything near 0). tanh(9) rounds to 1 in float, so clamping
+// to [-9, 9] is enough to keep expm1 in range, and min(hi, x) first keeps NaN (see exp2_safe)
+template <int Degree = 5, typename V>
+inline V tanh(V x) {
+	x = max(broadcast<V>(-9.0f), min(broadcast<V>(9.0f), x));
+	V e = expm1<Degree>(add(x, x));
+	return div(e, add(e, broadcast<V>(2.0f)));
+}
+
+// the tanh approximation of GELU (the one in GPT-2, PyTorch's approximate="tanh"):
+//   0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+// and since 0.5 * (1 + tanh(u)) = sigmoid(2u), it's just x / (1 + e^(-2u)). It differs from
+// the exact x * Phi(x) by up to ~5e-4, so compare it with the same formula
+template <int Degree = 5, typename V>
+inline V gelu(V x) {
+	static constexpr float c0 = -2.0f * 0.7978845608028654f;
+	static constexpr float c1 = -2.0f * 0.7978845608028654f * 0.044715f;
+
+	V minus_2u = mul(x, fmadd(mul(x, x), broadcast<V>(c1), broadcast<V>(c0)));
+	return div(x, add(broadcast<V>(1.0f), exp_safe<Degree>(minus_2u)));
+}
+
+
+
+template <int Degree = 5>
+inline void sigmoid(const float* in, float* out, size_t n) {
+	transform(in, out, n, [](__m256 x) { return vecmath::sigmoid<Degree>(x); });
+}
+
+template <int Degree = 5>
+inline void silu(const float* in, float* out, size_t n) {
+	transform(in, out, n, [](__m256 x) { return vecmath::silu<Degree>(x); });
+}
+
+template <int Degree = 5>
+inline void tanh(const float* in, float* out, size_t n) {
+	transform(in, out, n, [](__m256 x) { return vecmath::tanh<Degree>(x); });
+}
+
+template <int Degree = 5>
+inline void gelu(const float* in, float* out, size_t n) {
+	transform(in, out, n, [](__m256 x) { return vecmath::gelu<Degree>(x); });
+}
+
+
+
+// softmax of every row of a rows x cols matrix (row major, in == out is fine). The usual
+// stable version takes 3 passes: max, then e^(x - max) and its sum, then the division. Here the
+// first two are fused with a running max: every lane keeps its own max m and sum s of
+// e^(x - m), and when m grows s gets multiplied by e^(m_old - m_new). The max is taken over
+// 4 registers at a time, and once the big values have been seen it almost never changes, so
+// the rescaling gets skipped with a branch. It has to be skipped anyway for the lanes that
+// didn't change: e^0 isn't exactly 1 with these polynomials (1.0037 for degree 2), and
+// multiplying by it every time makes the sums drift. The second pass computes e^(x - max)
+// again and multiplies by 1 / sum, so the row is read twice and written once.
+// The running max starts at -FLT_MAX instead of -inf, so rows with -inf in them (masks) work,
+// m_old - m_new would be -inf - -inf = NaN otherwise
+template <int Degree = 5>
+inline void softmax(const float* in, float* out, size_t rows, size_t cols) {
+	static constexpr size_t W = 8;
+
+	auto e = [](__m256 x, __m256 m) { return vecmath::exp_safe<Degree>(_mm256_sub_ps(x, m)); };
+
+	auto rescale = [&](__m256 s, __m256 m, __m256 m_new) {
+		__m256 changed = _mm256_cmp_ps(m, m_new, _CMP_NEQ_OQ);
+		if (_mm256_testz_ps(changed, changed)) return s;
+		return _mm256_mul_ps(s, _mm256_blendv_ps(_mm256_set1_ps(1.0f), e(m, m_new), changed));
+	};
+
+	for (size_t r = 0; r < rows; ++r) {
+		const float* x = in + r * cols;
+		float* y = out + r * cols;
+
+		__m256 m = _mm256_set1_ps(-FLT_MAX);
+		__m256 s = _mm256_setzero_ps();
+
+		size_t i = 0;
+		for (; i + 4 * W <= cols; i += 4 * W) {
+			__m256 x0 = _mm256_loadu_ps(x + i);
+			__m256 x1 = _mm256_loadu_ps(x + i + W);
+			__m256 x2 = _mm256_loadu_ps(x + i + 2 * W);
+			__m256 x3 = _mm256_loadu_ps(x + i + 3 * W);
+
+			__m256 m_new = _mm256_max_ps(m, _mm256_max_ps(_mm256_max_ps(x0, x1), _mm256_max_ps(x2, x3)));
+			s = rescale(s, m, m_new);
+			s = _mm256_add_ps(s, _mm256_add_ps(_mm256_add_ps(e(x0, m_new), e(x1, m_new)), _mm256_add_ps(e(x2, m_new), e(x3, m_new))));
+			m = m_new;
+		}
+
+		for (; i + W <= cols; i += W) {
+			__m256 x0 = _mm256_loadu_ps(x + i);
+			__m256 m_new = _mm256_max_ps(m, x0);
+			s = _mm256_add_ps(rescale(s, m, m_new), e(x0, m_new));
+			m = m_new;
+		}
+
+		// masked off lanes become -inf, so they don't move the max and add e^-inf = 0
+		if (i < cols) {
+			__m256i mask = tail_mask(cols - i);
+			__m256 x0 = _mm256_blendv_ps(_mm256_set1_ps(-INFINITY), _mm256_maskload_ps(x + i, mask), _mm256_castsi256_ps(mask));
+			__m256 m_new = _mm256_max_ps(m, x0);
+			s = _mm256_add_ps(rescale(s, m, m_new), e(x0, m_new));
+			m = m_new;
+		}
+
+		// combine the lanes: bring all the sums to the same max
+		alignas(32) float lanes[W];
+		_mm256_store_ps(lanes, m);
+		float row_max = lanes[0];
+		for (size_t l = 1; l < W; ++l) row_max = std::max(row_max, lanes[l]);
+
+		__m256 v_max = _mm256_set1_ps(row_max);
+		_mm256_store_ps(lanes, rescale(s, m, v_max));
+		float sum = 0.0f;
+		for (size_t l = 0; l < W; ++l) sum += lanes[l];
+
+		__m256 scale = _mm256_set1_ps(1.0f / sum);
+		transform(x, y, cols, [&](__m256 v) { return _mm256_mul_ps(e(v, v_max), scale); });
+	}
+}
+
+}
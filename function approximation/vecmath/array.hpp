@@ -0,0 +1,87 @@
+#pragma once
+
+#include "common.hpp"
+#include "exp.hpp"
+#include "log.hpp"
+
+
+
+// array versions: out[i] = f(in[i]) for i in [0, n). The main loop works on Unroll
+// independent registers at a time, so the dependency chains of the polynomials overlap
+// and the FMA units stay busy (one register at a time is bound by latency, not throughput).
+// The last n % 8 elements are done with masked loads and stores instead of a scalar loop,
+// so n doesn't need to be a multiple of anything. in == out (in-place) is fine, every
+// register is loaded before anything is stored over it
+
+namespace vecmath {
+
+// mask with the first r lanes set, for _mm256_maskload_ps / _mm256_maskstore_ps
+inline __m256i tail_mask(size_t r) {
+	return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(r)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+template <size_t Unroll = 4, typename F>
+inline void transform(const float* in, float* out, size_t n, F f) {
+	static constexpr size_t W = 8;
+
+	// without the pragmas GCC -O2 keeps x[] in memory and this ends up slower than no unrolling at all
+	size_t i = 0;
+	for (; i + Unroll * W <= n; i += Unroll * W) {
+		__m256 x[Unroll];
+		#pragma GCC unroll 16
+		for (size_t u = 0; u < Unroll; ++u) x[u] = _mm256_loadu_ps(in + i + u * W);
+		#pragma GCC unroll 16
+		for (size_t u = 0; u < Unroll; ++u) x[u] = f(x[u]);
+		#pragma GCC unroll 16
+		for (size_t u = 0; u < Unroll; ++u) _mm256_storeu_ps(out + i + u * W, x[u]);
+	}
+
+	for (; i + W <= n; i += W) {
+		_mm256_storeu_ps(out + i, f(_mm256_loadu_ps(in + i)));
+	}
+
+	// masked off lanes load as 0 and never get stored, so whatever f does with them is fine
+	if (i < n) {
+		__m256i mask = tail_mask(n - i);
+		_mm256_maskstore_ps(out + i, mask, f(_mm256_maskload_ps(in + i, mask)));
+	}
+}
+
+
+
+template <int Degree = 5>
+inline void exp2(const float* in, float* out, size_t n) {
+	transform(in, out, n, [](__m256 x) { return vecmath::exp2<Degree>(x); });
+}
+
+template <int Degree = 5>
+inline void exp(const float* in, float* out, size_t n) {
+	transform(in, out, n, [](__m256 x) { return vecmath::exp<Degree>(x); });
+}
+
+template <int Degree = 5, bool Denormals = false>
+inline void exp2_safe(const float* in, float* out, size_t n) {
+	transform(in, out, n, [](__m256 x) { return vecmath::exp2_safe<Degree, Denormals>(x); });
+}
+
+template <int Degree = 5, bool Denormals = false>
+inline void exp_safe(const float* in, float* out, size_t n) {
+	transform(in, out, n, [](__m256 x) { return vecmath::exp_safe<Degree, Denormals>(x); });
+}
+
+template <int Degree = 5>
+inline void expm1(const float* in, float* out, size_t n) {
+	transform(in, out, n, [](__m256 x) { return vecmath::expm1<Degree>(x); });
+}
+
+template <int Degree = 5>
+inline void log2(const float* in, float* out, size_t n) {
+	transform(in, out, n, [](__m256 x) { return vecmath::log2<Degree>(x); });
+}
+
+template <int Degree = 5>
+inline void log(const float* in, float* out, size_t n) {
+	transform(in, out, n, [](__m256 x) { return vecmath::log<Degree>(x); });
+}
+
+}
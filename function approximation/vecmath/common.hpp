@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <algorithm>
+#include <x86intrin.h>
+
+
+
+// small set of overloads so the same code (mostly polynomial evaluation) can be written once
+// for float, __m256 and __m512. The __m256 versions need AVX2 + FMA and the __m512 ones
+// AVX-512F, everything is meant to be compiled with -march=native like the rest of the repo
+
+namespace vecmath {
+
+template <typename V> V broadcast(float a);
+
+template <> inline float broadcast<float>(float a) { return a; }
+template <> inline __m256 broadcast<__m256>(float a) { return _mm256_set1_ps(a); }
+
+inline float add(float a, float b) { return a + b; }
+inline float sub(float a, float b) { return a - b; }
+inline float mul(float a, float b) { return a * b; }
+inline float div(float a, float b) { return a / b; }
+
+// same NaN behaviour as minps/maxps: the second operand comes out if either one is NaN
+inline float min(float a, float b) { return a < b ? a : b; }
+inline float max(float a, float b) { return a > b ? a : b; }
+
+// std::fma is a libm call if the CPU has no FMA, so only use it when it's a single instruction
+inline float fmadd(float a, float b, float c) {
+#ifdef __FMA__
+	return std::fma(a, b, c);
+#else
+	return a * b + c;
+#endif
+}
+
+inline __m256 add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+inline __m256 sub(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+inline __m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+inline __m256 div(__m256 a, __m256 b) { return _mm256_div_ps(a, b); }
+inline __m256 min(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+inline __m256 max(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+inline __m256 fmadd(__m256 a, __m256 b, __m256 c) { return _mm256_fmadd_ps(a, b, c); }
+
+#ifdef __AVX512F__
+template <> inline __m512 broadcast<__m512>(float a) { return _mm512_set1_ps(a); }
+
+inline __m512 add(__m512 a, __m512 b) { return _mm512_add_ps(a, b); }
+inline __m512 sub(__m512 a, __m512 b) { return _mm512_sub_ps(a, b); }
+inline __m512 mul(__m512 a, __m512 b) { return _mm512_mul_ps(a, b); }
+inline __m512 div(__m512 a, __m512 b) { return _mm512_div_ps(a, b); }
+inline __m512 min(__m512 a, __m512 b) { return _mm512_min_ps(a, b); }
+inline __m512 max(__m512 a, __m512 b) { return _mm512_max_ps(a, b); }
+inline __m512 fmadd(__m512 a, __m512 b, __m512 c) { return _mm512_fmadd_ps(a, b, c); }
+#endif
+
+}
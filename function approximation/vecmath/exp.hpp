@@ -0,0 +1,216 @@
+#pragma once
+
+#include "common.hpp"
+#include "poly.hpp"
+
+
+
+// 2^x, e^x and e^x - 1. Degree (2 to 5) picks the polynomial used for 2^d, d in [0, 1),
+// which are the same least squares fits as approx_exp2_v5..v8. Max relative errors:
+//   exp2:  Degree 2: 3.8e-3, Degree 3: 1.9e-4, Degree 4: 7.3e-6, Degree 5: 3.0e-7
+//   expm1: Degree 2: 7.5e-3, Degree 3: 3.8e-4, Degree 4: 1.5e-5, Degree 5: 6.6e-7
+// exp is the same as exp2 plus the rounding of x * log2(e), which matters for big |x|
+// like the original kernels, nothing is range checked: x has to stay in about [-126, 127].
+// exp2_safe / exp_safe handle everything else (see below)
+
+namespace vecmath {
+
+// lowest degree first (see poly.hpp)
+template <int Degree> struct exp2_coeffs;
+
+template <> struct exp2_coeffs<2> : polynomial<1.003762902276502f, 0.649426903806752f, 0.342656060127262f> {};
+template <> struct exp2_coeffs<3> : polynomial<0.999811907929616f, 0.696838835969343f, 0.224126229720834f, 0.079019886937600f> {};
+template <> struct exp2_coeffs<4> : polynomial<1.000007286841045f, 0.692931257740765f, 0.241710331749456f, 0.051666839337489f, 0.013676523800069f> {};
+template <> struct exp2_coeffs<5> : polynomial<0.999999769472682f, 0.693156778791506f, 0.240131684394877f, 0.055876565615224f, 0.008940581738581f, 0.001894376824293f> {};
+
+
+// (e^x - 1 - x) / x^2 for x in [-0.5, 0.5], used by expm1 where e^x - 1 would cancel
+template <int Degree> struct expm1_coeffs;
+
+template <> struct expm1_coeffs<2> : polynomial<5.000000000e-01f, 1.682361603e-01f, 4.192795708e-02f> {};
+template <> struct expm1_coeffs<3> : polynomial<4.999891007e-01f, 1.666651112e-01f, 4.201524846e-02f, 8.383087506e-03f> {};
+template <> struct expm1_coeffs<4> : polynomial<5.000000000e-01f, 1.666627746e-01f, 4.166618058e-02f, 8.395553053e-03f, 1.396660952e-03f> {};
+template <> struct expm1_coeffs<5> : polynomial<5.000000122e-01f, 1.666666680e-01f, 4.166579123e-02f, 8.333236133e-03f, 1.398218605e-03f, 1.994487446e-04f> {};
+
+// how the polynomials get evaluated (see poly.hpp), from benchmark/benchmark.cpp
+static constexpr scheme exp2_scheme = scheme::mixed;
+static constexpr scheme expm1_scheme = scheme::mixed;
+
+static constexpr float LOG2E = 1.44269504088896340736f;
+
+
+
+template <int Degree = 5, scheme S = exp2_scheme>
+inline float exp2(float x) {
+	float fi = std::floor(x);
+	float d = x - fi;
+
+	int i = (static_cast<int>(fi) + 127) << 23;
+
+	return std::bit_cast<float>(i) * exp2_coeffs<Degree>::template eval<S>(d);
+}
+
+template <int Degree = 5, scheme S = exp2_scheme>
+inline __m256 exp2(__m256 x) {
+	__m256 fi = _mm256_floor_ps(x);
+	__m256 d = _mm256_sub_ps(x, fi);
+
+	// (i + 127) << 23 is 2^i (AVX2 has integer shifts, so no need for the float multiplication trick)
+	__m256i i = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(fi), _mm256_set1_epi32(127)), 23);
+
+	return _mm256_mul_ps(_mm256_castsi256_ps(i), exp2_coeffs<Degree>::template eval<S>(d));
+}
+
+#ifdef __AVX512F__
+// GCC 12 warns about '__Y' being used uninitialized inside the avx512fintrin.h intrinsics
+// (the _mm512_undefined_* they start from) in every TU that instantiates these. False positive
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+// scalef does p * 2^floor(fi) in one instruction, and it even saturates to 0 and inf properly
+template <int Degree = 5, scheme S = exp2_scheme>
+inline __m512 exp2(__m512 x) {
+	__m512 fi = _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+	__m512 d = _mm512_sub_ps(x, fi);
+
+	return _mm512_scalef_ps(exp2_coeffs<Degree>::template eval<S>(d), fi);
+}
+
+#pragma GCC diagnostic pop
+#endif
+
+
+
+// exp2 for any input: 0 and inf when the result underflows or overflows, NaN stays NaN. Clamping
+// x to [-127, 128] is enough for that, since i + 127 is then 0 (the bits of 0.0f) or 255 (the bits
+// of inf) at the ends, and the clamp is written as min(hi, x) first because min/max return their
+// second operand when there's a NaN, so it goes through the polynomial and comes out as NaN.
+// That's 2 instructions on top of exp2.
+//
+// exp2 flushes to 0 below 2^-126. With Denormals = true 2^i is split into 2^(i/2) * 2^(i - i/2),
+// both normal, so the last multiplication rounds to the right denormal (6 more instructions: p(0)
+// is a bit less than 1, so x >= 128 also needs an explicit blend to inf). The AVX-512 version
+// always gives denormals, since scalef already does. Careful: on Intel every multiplication that
+// produces a denormal (or underflows to 0) takes a microcode assist of ~100+ cycles, so with
+// many such inputs Denormals = true is way slower, and the instructions aren't the reason
+template <int Degree = 5, bool Denormals = false, scheme S = exp2_scheme>
+inline float exp2_safe(float x) {
+	if (std::isnan(x)) return x;
+
+	x = std::clamp(x, Denormals ? -151.0f : -127.0f, Denormals ? 129.0f : 128.0f);
+
+	float fi = std::floor(x);
+	float d = x - fi;
+	int i = static_cast<int>(fi);
+
+	float p = exp2_coeffs<Degree>::template eval<S>(d);
+
+	if constexpr (Denormals) {
+		int i1 = i >> 1;
+		int i2 = i - i1;
+		float r = p * std::bit_cast<float>((i1 + 127) << 23) * std::bit_cast<float>((i2 + 127) << 23);
+		return (x >= 128.0f) ? INFINITY : r;
+	}
+
+	return std::bit_cast<float>((i + 127) << 23) * p;
+}
+
+template <int Degree = 5, bool Denormals = false, scheme S = exp2_scheme>
+inline __m256 exp2_safe(__m256 x) {
+	x = _mm256_max_ps(_mm256_set1_ps(Denormals ? -151.0f : -127.0f), _mm256_min_ps(_mm256_set1_ps(Denormals ? 129.0f : 128.0f), x));
+
+	__m256 fi = _mm256_floor_ps(x);
+	__m256 d = _mm256_sub_ps(x, fi);
+	__m256i i = _mm256_cvtps_epi32(fi);
+
+	__m256 p = exp2_coeffs<Degree>::template eval<S>(d);
+
+	const __m256i bias = _mm256_set1_epi32(127);
+
+	if constexpr (Denormals) {
+		__m256i i1 = _mm256_srai_epi32(i, 1);
+		__m256i i2 = _mm256_sub_epi32(i, i1);
+		__m256 s1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(i1, bias), 23));
+		__m256 s2 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(i2, bias), 23));
+		__m256 r = _mm256_mul_ps(_mm256_mul_ps(p, s1), s2);
+		return _mm256_blendv_ps(r, _mm256_set1_ps(INFINITY), _mm256_cmp_ps(x, _mm256_set1_ps(128.0f), _CMP_GE_OQ));
+	}
+
+	return _mm256_mul_ps(_mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(i, bias), 23)), p);
+}
+
+#ifdef __AVX512F__
+// same false positive as exp2 above
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+// scalef already saturates, but inf - floor(inf) is NaN, so the clamp is still needed for +-inf
+// (and the blend for 2^128, same as above)
+template <int Degree = 5, bool Denormals = false, scheme S = exp2_scheme>
+inline __m512 exp2_safe(__m512 x) {
+	x = _mm512_max_ps(_mm512_set1_ps(-151.0f), _mm512_min_ps(_mm512_set1_ps(129.0f), x));
+	__mmask16 overflow = _mm512_cmp_ps_mask(x, _mm512_set1_ps(128.0f), _CMP_GE_OQ);
+	return _mm512_mask_blend_ps(overflow, vecmath::exp2<Degree, S>(x), _mm512_set1_ps(INFINITY));
+}
+
+#pragma GCC diagnostic pop
+#endif
+
+template <int Degree = 5, bool Denormals = false, scheme S = exp2_scheme, typename V>
+inline V exp_safe(V x) {
+	return vecmath::exp2_safe<Degree, Denormals, S>(mul(x, broadcast<V>(LOG2E)));
+}
+
+
+
+// e^x = 2^(x * log2(e)). Multiplying first adds about one rounding error relative to exp2
+template <int Degree = 5, scheme S = exp2_scheme, typename V>
+inline V exp(V x) {
+	return vecmath::exp2<Degree, S>(mul(x, broadcast<V>(LOG2E)));
+}
+
+
+
+// near 0, e^x - 1 loses all its precision, so use x + x^2 * q(x) there instead
+template <int Degree = 5, scheme S = expm1_scheme>
+inline float expm1(float x) {
+	if (std::abs(x) < 0.5f) {
+		return fmadd(x * x, expm1_coeffs<Degree>::template eval<S>(x), x);
+	}
+	return vecmath::exp<Degree>(x) - 1.0f;
+}
+
+template <int Degree = 5, scheme S = expm1_scheme>
+inline __m256 expm1(__m256 x) {
+	__m256 abs_x = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+	__m256 small = _mm256_cmp_ps(abs_x, _mm256_set1_ps(0.5f), _CMP_LT_OQ);
+
+	__m256 near = _mm256_fmadd_ps(_mm256_mul_ps(x, x), expm1_coeffs<Degree>::template eval<S>(x), x);
+	__m256 far = _mm256_sub_ps(vecmath::exp<Degree>(x), _mm256_set1_ps(1.0f));
+
+	return _mm256_blendv_ps(far, near, small);
+}
+
+#ifdef __AVX512F__
+// same false positive as exp2 above
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+template <int Degree = 5, scheme S = expm1_scheme>
+inline __m512 expm1(__m512 x) {
+	__m512 abs_x = _mm512_abs_ps(x);
+	__mmask16 small = _mm512_cmp_ps_mask(abs_x, _mm512_set1_ps(0.5f), _CMP_LT_OQ);
+
+	__m512 near = _mm512_fmadd_ps(_mm512_mul_ps(x, x), expm1_coeffs<Degree>::template eval<S>(x), x);
+	__m512 far = _mm512_sub_ps(vecmath::exp<Degree>(x), _mm512_set1_ps(1.0f));
+
+	return _mm512_mask_blend_ps(small, far, near);
+}
+
+#pragma GCC diagnostic pop
+#endif
+
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <array>
+
+#include "common.hpp"
+
+
+
+// double precision 2^x and e^x, for double, __m256d and __m512d. The float trick (2^floor(x)
+// times a polynomial on [0, 1)) would need a polynomial of degree ~12 to get to double
+// precision (x has 53 bits now), so here x is split as x = (m * N + j) / N + r with N = 2^TableBits:
+//   2^x = 2^m * 2^(j / N) * 2^r,  |r| <= 1 / (2N)
+// 2^(j / N) comes from a table of N doubles and 2^r is a Taylor polynomial of degree Degree,
+// which gets really short once r is small. Bigger tables mean shorter polynomials, and these
+// are the smallest degrees that keep the max error under 1.2 ULP:
+//   TableBits 2 (32 bytes, in a register): Degree 9
+//   TableBits 3 (64 bytes):                Degree 8
+//   TableBits 4 (128 bytes):               Degree 7
+//   TableBits 7 (1 KB, the default):       Degree 5
+//   TableBits 10 (8 KB, half of L1):       Degree 4
+// (measured against long double on 10^7 random x, see exponentials/benchmarks_double.cpp; one
+// degree less costs 5-10 ULP). With up to 4 entries (AVX2) or 16 (AVX-512) the table lives in
+// registers and the lookup is a permute, otherwise it's a gather. Not range checked: 2^x needs
+// x in [-1022, 1024), e^x in [-708, 709]
+
+namespace vecmath {
+
+// e^(y * ln(2)) in long double with plenty of Taylor terms, only used to build tables at compile time
+constexpr long double constexpr_exp2(long double y) {
+	long double z = y * 0.693147180559945309417232121458176568L;
+	long double term = 1.0L;
+	long double sum = 1.0L;
+	for (int k = 1; k < 40; ++k) {
+		term *= z / k;
+		sum += term;
+	}
+	return sum;
+}
+
+template <int TableBits>
+struct exp2_table_values {
+	static constexpr int N = 1 << TableBits;
+
+	// at least 8 entries, so the permute versions can always load whole registers
+	alignas(64) static constexpr std::array<double, (N < 8 ? 8 : N)> values = [] {
+		std::array<double, (N < 8 ? 8 : N)> t{};
+		for (int j = 0; j < N; ++j) t[j] = static_cast<double>(constexpr_exp2(static_cast<long double>(j) / N));
+		return t;
+	}();
+};
+
+// Taylor coefficients, lowest degree first: (ln 2)^k / k! for 2^r and 1 / k! for e^r
+template <int Degree, bool Natural>
+struct exp_taylor {
+	static constexpr std::array<double, Degree + 1> c = [] {
+		std::array<double, Degree + 1> t{};
+		long double term = 1.0L;
+		for (int k = 0; k <= Degree; ++k) {
+			t[k] = static_cast<double>(term);
+			term *= (Natural ? 1.0L : 0.693147180559945309417232121458176568L) / (k + 1);
+		}
+		return t;
+	}();
+};
+
+// adding 1.5 * 2^52 rounds to an integer and leaves it in the low bits of the mantissa
+static constexpr double ROUND_MAGIC = 6755399441055744.0;
+
+static constexpr long double LN2_LD = 0.693147180559945309417232121458176568L;
+
+
+
+// the parts shared by exp2 and exp: t = k + ROUND_MAGIC (k is the integer (m * N + j)) and
+// q = 2^r - 1 (the polynomial without its constant term, so the result is s + s * q with a
+// single rounding, instead of rounding 1 + q first, which costs almost 1 ULP). j is in the
+// low TableBits bits of t, and m is in the next 12, so both come out with integer ops, and
+// 2^m gets added straight to the exponent bits of the table value (the shifts are logical,
+// but the top bits of m are thrown away by << 52 anyway)
+template <int TableBits>
+inline double exp_table_scale(double t, double q) {
+	uint64_t bits = std::bit_cast<uint64_t>(t);
+	uint64_t j = bits & ((uint64_t(1) << TableBits) - 1);
+	uint64_t e = (bits >> TableBits) << 52;
+
+	double s = std::bit_cast<double>(std::bit_cast<uint64_t>(exp2_table_values<TableBits>::values[j]) + e);
+	return std::fma(s, q, s);
+}
+
+template <int Degree, bool Natural>
+inline double exp_table_poly(double r) {
+	const auto& c = exp_taylor<Degree, Natural>::c;
+	double q = c[Degree];
+	#pragma GCC unroll 16
+	for (int k = Degree; k > 1; --k) q = std::fma(q, r, c[k - 1]);
+	return q * r;
+}
+
+template <int TableBits = 7, int Degree = 5>
+inline double exp2_table(double x) {
+	static constexpr double N = 1 << TableBits;
+
+	double t = std::fma(x, N, ROUND_MAGIC);
+	double k = t - ROUND_MAGIC;
+
+	// x * N - k is exact (N is a power of 2), and so is the division
+	double r = std::fma(x, N, -k) * (1.0 / N);
+
+	return exp_table_scale<TableBits>(t, exp_table_poly<Degree, false>(r));
+}
+
+// e^x = 2^(x / ln 2), but x / ln 2 can't be rounded before splitting it, the error would get
+// multiplied by |x|. So k comes from x * N / ln 2 and r = x - k * ln 2 / N is computed with
+// ln 2 / N in two parts (high and low, Cody-Waite style, with FMAs), and 2^r becomes e^r
+template <int TableBits = 7, int Degree = 5>
+inline double exp_table(double x) {
+	static constexpr double N = 1 << TableBits;
+	static constexpr double C1 = static_cast<double>(LN2_LD / N);
+	static constexpr double C2 = static_cast<double>(LN2_LD / N - C1);
+
+	double t = std::fma(x, static_cast<double>(N / LN2_LD), ROUND_MAGIC);
+	double k = t - ROUND_MAGIC;
+
+	double r = std::fma(-k, C1, x);
+	r = std::fma(-k, C2, r);
+
+	return exp_table_scale<TableBits>(t, exp_table_poly<Degree, true>(r));
+}
+
+
+
+template <int TableBits>
+inline __m256d exp_table_scale(__m256d t, __m256d q) {
+	__m256i bits = _mm256_castpd_si256(t);
+	__m256i j = _mm256_and_si256(bits, _mm256_set1_epi64x((1 << TableBits) - 1));
+	__m256i e = _mm256_slli_epi64(_mm256_srli_epi64(bits, TableBits), 52);
+
+	const double* table = exp2_table_values<TableBits>::values.data();
+
+	__m256d s;
+	if constexpr (TableBits <= 2) {
+		// there's no variable permute of doubles across lanes in AVX2, so permute the 32 bit
+		// halves instead, with indices 2j and 2j + 1. For 8 entries two of these plus a blend
+		// were slower than the gather
+		__m256i j2 = _mm256_slli_epi64(j, 1);
+		__m256i idx = _mm256_or_si256(j2, _mm256_slli_epi64(_mm256_or_si256(j2, _mm256_set1_epi64x(1)), 32));
+
+		s = _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(_mm256_load_pd(table)), idx));
+	} else {
+		s = _mm256_i64gather_pd(table, j, 8);
+	}
+
+	s = _mm256_castsi256_pd(_mm256_add_epi64(_mm256_castpd_si256(s), e));
+	return _mm256_fmadd_pd(s, q, s);
+}
+
+template <int Degree, bool Natural>
+inline __m256d exp_table_poly(__m256d r) {
+	const auto& c = exp_taylor<Degree, Natural>::c;
+	__m256d q = _mm256_set1_pd(c[Degree]);
+	#pragma GCC unroll 16
+	for (int k = Degree; k > 1; --k) q = _mm256_fmadd_pd(q, r, _mm256_set1_pd(c[k - 1]));
+	return _mm256_mul_pd(q, r);
+}
+
+template <int TableBits = 7, int Degree = 5>
+inline __m256d exp2_table(__m256d x) {
+	const __m256d N = _mm256_set1_pd(1 << TableBits);
+	const __m256d magic = _mm256_set1_pd(ROUND_MAGIC);
+
+	__m256d t = _mm256_fmadd_pd(x, N, magic);
+	__m256d k = _mm256_sub_pd(t, magic);
+	__m256d r = _mm256_mul_pd(_mm256_fmsub_pd(x, N, k), _mm256_set1_pd(1.0 / (1 << TableBits)));
+
+	return exp_table_scale<TableBits>(t, exp_table_poly<Degree, false>(r));
+}
+
+template <int TableBits = 7, int Degree = 5>
+inline __m256d exp_table(__m256d x) {
+	static constexpr double N = 1 << TableBits;
+	static constexpr double C1 = static_cast<double>(LN2_LD / N);
+	static constexpr double C2 = static_cast<double>(LN2_LD / N - C1);
+
+	const __m256d magic = _mm256_set1_pd(ROUND_MAGIC);
+
+	__m256d t = _mm256_fmadd_pd(x, _mm256_set1_pd(static_cast<double>(N / LN2_LD)), magic);
+	__m256d k = _mm256_sub_pd(t, magic);
+
+	__m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(C1), x);
+	r = _mm256_fnmadd_pd(k, _mm256_set1_pd(C2), r);
+
+	return exp_table_scale<TableBits>(t, exp_table_poly<Degree, true>(r));
+}
+
+
+
+#ifdef __AVX512F__
+// same GCC 12 false positive as in exp.hpp, '__Y' may be used uninitialized inside the
+// avx512fintrin.h intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+template <int TableBits>
+inline __m512d exp_table_scale(__m512d t, __m512d q) {
+	__m512i bits = _mm512_castpd_si512(t);
+	__m512i j = _mm512_and_si512(bits, _mm512_set1_epi64((1 << TableBits) - 1));
+	__m512i e = _mm512_slli_epi64(_mm512_srli_epi64(bits, TableBits), 52);
+
+	const double* table = exp2_table_values<TableBits>::values.data();
+
+	// up to 8 entries fit in one register and 16 in two (permutex2var picks from both)
+	__m512d s;
+	if constexpr (TableBits <= 3) {
+		s = _mm512_permutexvar_pd(j, _mm512_load_pd(table));
+	} else if constexpr (TableBits == 4) {
+		s = _mm512_permutex2var_pd(_mm512_load_pd(table), j, _mm512_load_pd(table + 8));
+	} else {
+		s = _mm512_i64gather_pd(j, table, 8);
+	}
+
+	s = _mm512_castsi512_pd(_mm512_add_epi64(_mm512_castpd_si512(s), e));
+	return _mm512_fmadd_pd(s, q, s);
+}
+
+template <int Degree, bool Natural>
+inline __m512d exp_table_poly(__m512d r) {
+	const auto& c = exp_taylor<Degree, Natural>::c;
+	__m512d q = _mm512_set1_pd(c[Degree]);
+	#pragma GCC unroll 16
+	for (int k = Degree; k > 1; --k) q = _mm512_fmadd_pd(q, r, _mm512_set1_pd(c[k - 1]));
+	return _mm512_mul_pd(q, r);
+}
+
+template <int TableBits = 7, int Degree = 5>
+inline __m512d exp2_table(__m512d x) {
+	const __m512d N = _mm512_set1_pd(1 << TableBits);
+	const __m512d magic = _mm512_set1_pd(ROUND_MAGIC);
+
+	__m512d t = _mm512_fmadd_pd(x, N, magic);
+	__m512d k = _mm512_sub_pd(t, magic);
+	__m512d r = _mm512_mul_pd(_mm512_fmsub_pd(x, N, k), _mm512_set1_pd(1.0 / (1 << TableBits)));
+
+	return exp_table_scale<TableBits>(t, exp_table_poly<Degree, false>(r));
+}
+
+template <int TableBits = 7, int Degree = 5>
+inline __m512d exp_table(__m512d x) {
+	static constexpr double N = 1 << TableBits;
+	static constexpr double C1 = static_cast<double>(LN2_LD / N);
+	static constexpr double C2 = static_cast<double>(LN2_LD / N - C1);
+
+	const __m512d magic = _mm512_set1_pd(ROUND_MAGIC);
+
+	__m512d t = _mm512_fmadd_pd(x, _mm512_set1_pd(static_cast<double>(N / LN2_LD)), magic);
+	__m512d k = _mm512_sub_pd(t, magic);
+
+	__m512d r = _mm512_fnmadd_pd(k, _mm512_set1_pd(C1), x);
+	r = _mm512_fnmadd_pd(k, _mm512_set1_pd(C2), r);
+
+	return exp_table_scale<TableBits>(t, exp_table_poly<Degree, true>(r));
+}
+
+#pragma GCC diagnostic pop
+#endif
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "common.hpp"
+#include "poly.hpp"
+
+
+
+// log2(x) and ln(x). x = 2^e * m with m in [sqrt(2) / 2, sqrt(2)), and then
+// log(m) = 2 * atanh(s) with s = (m - 1) / (m + 1), which is an odd function of s with
+// |s| <= 0.1716, so a polynomial in s^2 converges really fast. Max relative errors of
+// log2 for x in [0.5, 2] (the worst range, for bigger exponents it gets better):
+//   Degree 2: 5.0e-3, Degree 3: 2.3e-5, Degree 4: 3.3e-7, Degree 5: 2.0e-7
+// x has to be a positive normal float, denormals, 0, negatives, inf and NaN give garbage
+
+namespace vecmath {
+
+// coefficients of 2 * atanh(s) / s as a polynomial in z = s^2, minimax-like fits (Chebyshev
+// interpolation) on [0, (3 - 2 * sqrt(2))^2]. The log2 ones are the same divided by ln(2)
+template <int Degree> struct log_coeffs;
+
+template <> struct log_coeffs<2> {
+	using ln = polynomial<2.009899994e+00f>;
+	using log2 = polynomial<2.899672754e+00f>;
+};
+template <> struct log_coeffs<3> {
+	using ln = polynomial<1.999955743e+00f, 6.786625461e-01f>;
+	using log2 = polynomial<2.885326232e+00f, 9.791030897e-01f>;
+};
+template <> struct log_coeffs<4> {
+	using ln = polynomial<2.000000236e+00f, 6.665226673e-01f, 4.129490918e-01f>;
+	using log2 = polynomial<2.885390422e+00f, 9.615889467e-01f, 5.957596069e-01f>;
+};
+template <> struct log_coeffs<5> {
+	using ln = polynomial<1.999999999e+00f, 6.666681534e-01f, 3.997485052e-01f, 2.992439050e-01f>;
+	using log2 = polynomial<2.885390080e+00f, 9.617988388e-01f, 5.767151860e-01f, 4.317176977e-01f>;
+};
+
+// how the polynomials get evaluated (see poly.hpp), from benchmark/benchmark.cpp
+static constexpr scheme log_scheme = scheme::horner;
+
+static constexpr float LN2 = 0.69314718055994530942f;
+static constexpr float SQRT2 = 1.41421356237309504880f;
+
+
+
+// splits x into its exponent e and s = (m - 1) / (m + 1)
+inline float log_reduce(float x, float& e) {
+	uint32_t bits = std::bit_cast<uint32_t>(x);
+
+	int exponent = static_cast<int>(bits >> 23) - 127;
+	float m = std::bit_cast<float>((bits & 0x007FFFFF) | 0x3F800000);
+
+	if (m > SQRT2) {
+		m *= 0.5f;
+		exponent += 1;
+	}
+
+	e = static_cast<float>(exponent);
+	return (m - 1.0f) / (m + 1.0f);
+}
+
+inline __m256 log_reduce(__m256 x, __m256& e) {
+	__m256i bits = _mm256_castps_si256(x);
+
+	__m256i exponent = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+	__m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000)));
+
+	__m256 big = _mm256_cmp_ps(m, _mm256_set1_ps(SQRT2), _CMP_GT_OQ);
+	m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), big);
+
+	// the compare mask is -1 where true, so subtracting it adds 1
+	exponent = _mm256_sub_epi32(exponent, _mm256_castps_si256(big));
+
+	e = _mm256_cvtepi32_ps(exponent);
+	return _mm256_div_ps(_mm256_sub_ps(m, _mm256_set1_ps(1.0f)), _mm256_add_ps(m, _mm256_set1_ps(1.0f)));
+}
+
+#ifdef __AVX512F__
+// getexp and getmant do the bit fiddling for us
+inline __m512 log_reduce(__m512 x, __m512& e) {
+	e = _mm512_getexp_ps(x);
+	__m512 m = _mm512_getmant_ps(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_src);
+
+	__mmask16 big = _mm512_cmp_ps_mask(m, _mm512_set1_ps(SQRT2), _CMP_GT_OQ);
+	m = _mm512_mask_mul_ps(m, big, m, _mm512_set1_ps(0.5f));
+	e = _mm512_mask_add_ps(e, big, e, _mm512_set1_ps(1.0f));
+
+	return _mm512_div_ps(_mm512_sub_ps(m, _mm512_set1_ps(1.0f)), _mm512_add_ps(m, _mm512_set1_ps(1.0f)));
+}
+#endif
+
+
+
+template <int Degree = 5, scheme S = log_scheme, typename V>
+inline V log2(V x) {
+	V e;
+	V s = log_reduce(x, e);
+	return fmadd(s, log_coeffs<Degree>::log2::template eval<S>(mul(s, s)), e);
+}
+
+template <int Degree = 5, scheme S = log_scheme, typename V>
+inline V log(V x) {
+	V e;
+	V s = log_reduce(x, e);
+	return fmadd(e, broadcast<V>(LN2), mul(s, log_coeffs<Degree>::ln::template eval<S>(mul(s, s))));
+}
+
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <vector>
+
+#include "common.hpp"
+#include "array.hpp"
+
+
+
+// any function from a table: f is sampled on a uniform grid over [lo, hi] when the lut is
+// built, and evaluated by finding the interval of x and interpolating, with gathers for the
+// SIMD versions. No polynomial to fit and no range reduction to work out, so it works the
+// same for exp2, sin, sigmoid or some transfer function that only exists as code.
+//
+// linear: 2 floats per interval (f and the slope), error about h^2 / 8 * max |f''|
+// cubic:  Hermite, 4 floats per interval (the polynomial in t, built from f and f' at both
+//         ends), error about h^4 / 384 * max |f''''|, so it gets to float precision with a
+//         few hundred intervals for anything smooth
+// where h is the interval width. The derivatives for cubic come from f itself with finite
+// differences (in double, a quarter of an interval apart), so f only needs to be callable
+// with a double.
+//
+// the table takes bytes / (entry size) intervals, 16 KB by default: half of a 32 KB L1, the
+// other half is for the data going through. Outside [lo, hi] x is clamped (and NaN gives
+// f(lo)), there's no extrapolation
+
+namespace vecmath {
+
+enum class interpolation { linear, cubic };
+
+static constexpr size_t lut_default_bytes = 16384;
+
+template <interpolation I = interpolation::cubic>
+class lut {
+public:
+	// floats per interval
+	static constexpr int entry = (I == interpolation::linear) ? 2 : 4;
+
+	template <typename F>
+	lut(F f, float lo, float hi, size_t bytes = lut_default_bytes) : lo(lo), hi(hi) {
+		n = static_cast<int>(std::max<size_t>(1, bytes / (entry * sizeof(float))));
+		scale = static_cast<float>(n / (static_cast<double>(hi) - lo));
+
+		double h = (static_cast<double>(hi) - lo) / n;
+		table.resize(static_cast<size_t>(n) * entry);
+
+		for (int i = 0; i < n; ++i) {
+			double x0 = lo + i * h, x1 = lo + (i + 1) * h;
+			if (i == n - 1) x1 = hi;
+			double y0 = f(x0), y1 = f(x1);
+
+			float* c = table.data() + static_cast<size_t>(i) * entry;
+			if constexpr (I == interpolation::linear) {
+				c[0] = static_cast<float>(y0);
+				c[1] = static_cast<float>(y1 - y0);
+			} else {
+				// Hermite on t in [0, 1], with the derivatives scaled to t
+				double m0 = derivative(f, x0, h) * h, m1 = derivative(f, x1, h) * h;
+				c[0] = static_cast<float>(y0);
+				c[1] = static_cast<float>(m0);
+				c[2] = static_cast<float>(3.0 * (y1 - y0) - 2.0 * m0 - m1);
+				c[3] = static_cast<float>(2.0 * (y0 - y1) + m0 + m1);
+			}
+		}
+	}
+
+	size_t intervals() const { return static_cast<size_t>(n); }
+	size_t bytes() const { return table.size() * sizeof(float); }
+
+	float operator()(float x) const {
+		float u = vecmath::min(vecmath::max((x - lo) * scale, 0.0f), static_cast<float>(n));
+		int i = std::min(static_cast<int>(u), n - 1);
+		float t = u - static_cast<float>(i);
+
+		const float* c = table.data() + static_cast<size_t>(i) * entry;
+		if constexpr (I == interpolation::linear) return fmadd(c[1], t, c[0]);
+		else return fmadd(fmadd(fmadd(c[3], t, c[2]), t, c[1]), t, c[0]);
+	}
+
+	__m256 operator()(__m256 x) const {
+		// the max first: maxps returns its second operand for NaN, so the index is always valid
+		__m256 u = _mm256_mul_ps(_mm256_sub_ps(x, _mm256_set1_ps(lo)), _mm256_set1_ps(scale));
+		u = _mm256_min_ps(_mm256_max_ps(u, _mm256_setzero_ps()), _mm256_set1_ps(static_cast<float>(n)));
+
+		__m256i i = _mm256_min_epi32(_mm256_cvttps_epi32(u), _mm256_set1_epi32(n - 1));
+		__m256 t = _mm256_sub_ps(u, _mm256_cvtepi32_ps(i));
+
+		// the entries of an interval are next to each other, so the gathers of one lane hit
+		// the same cache line
+		__m256i k = _mm256_slli_epi32(i, (I == interpolation::linear) ? 1 : 2);
+		const float* c = table.data();
+
+		if constexpr (I == interpolation::linear) {
+			__m256 c0 = _mm256_i32gather_ps(c, k, 4);
+			__m256 c1 = _mm256_i32gather_ps(c + 1, k, 4);
+			return _mm256_fmadd_ps(c1, t, c0);
+		} else {
+			__m256 c0 = _mm256_i32gather_ps(c, k, 4);
+			__m256 c1 = _mm256_i32gather_ps(c + 1, k, 4);
+			__m256 c2 = _mm256_i32gather_ps(c + 2, k, 4);
+			__m256 c3 = _mm256_i32gather_ps(c + 3, k, 4);
+			return _mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_fmadd_ps(c3, t, c2), t, c1), t, c0);
+		}
+	}
+
+#ifdef __AVX512F__
+	__m512 operator()(__m512 x) const {
+		__m512 u = _mm512_mul_ps(_mm512_sub_ps(x, _mm512_set1_ps(lo)), _mm512_set1_ps(scale));
+		u = _mm512_min_ps(_mm512_max_ps(u, _mm512_setzero_ps()), _mm512_set1_ps(static_cast<float>(n)));
+
+		__m512i i = _mm512_min_epi32(_mm512_cvttps_epi32(u), _mm512_set1_epi32(n - 1));
+		__m512 t = _mm512_sub_ps(u, _mm512_cvtepi32_ps(i));
+
+		__m512i k = _mm512_slli_epi32(i, (I == interpolation::linear) ? 1 : 2);
+		const float* c = table.data();
+
+		if constexpr (I == interpolation::linear) {
+			__m512 c0 = _mm512_i32gather_ps(k, c, 4);
+			__m512 c1 = _mm512_i32gather_ps(k, c + 1, 4);
+			return _mm512_fmadd_ps(c1, t, c0);
+		} else {
+			__m512 c0 = _mm512_i32gather_ps(k, c, 4);
+			__m512 c1 = _mm512_i32gather_ps(k, c + 1, 4);
+			__m512 c2 = _mm512_i32gather_ps(k, c + 2, 4);
+			__m512 c3 = _mm512_i32gather_ps(k, c + 3, 4);
+			return _mm512_fmadd_ps(_mm512_fmadd_ps(_mm512_fmadd_ps(c3, t, c2), t, c1), t, c0);
+		}
+	}
+#endif
+
+	// array version, same rules as the ones in array.hpp
+	void operator()(const float* in, float* out, size_t count) const {
+		transform(in, out, count, [this](__m256 x) { return (*this)(x); });
+	}
+
+private:
+	// 4th order finite differences, centered where there's room and one-sided at the ends of
+	// the table, so f never gets called outside [lo, hi]
+	template <typename F>
+	double derivative(F& f, double x, double h) const {
+		double e = h / 4;
+		if (x - 2 * e >= lo && x + 2 * e <= hi) {
+			return (f(x - 2 * e) - 8.0 * f(x - e) + 8.0 * f(x + e) - f(x + 2 * e)) / (12.0 * e);
+		}
+		if (x - 2 * e < lo) e = -e;
+		return -(-25.0 * f(x) + 48.0 * f(x - e) - 36.0 * f(x - 2 * e) + 16.0 * f(x - 3 * e) - 3.0 * f(x - 4 * e)) / (12.0 * e);
+	}
+
+	float lo, hi, scale;
+	int n;
+	std::vector<float> table;
+};
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <utility>
+
+#include "common.hpp"
+
+
+
+// compile-time polynomials: poly_eval<c0, c1, ..., cn>(x) = c0 + c1 * x + ... + cn * x^n,
+// with the coefficients as float template parameters (C++20). The recursion unrolls into
+// exactly the Horner chain we used to write by hand (one FMA per degree), for float,
+// __m256 or __m512, and it doesn't depend on the optimizer deciding to unroll a loop.
+//
+// Horner is the fewest instructions, but every FMA waits for the last one, so degree n costs
+// n FMA latencies (4 cycles each on most x86). poly_eval<scheme, c0, ..., cn>(x) can also
+// evaluate the same coefficients as:
+//   estrin: c0 + c1 x, c2 + c3 x, ... all at once, then the same on those with x^2, x^4...
+//           log2(n + 1) FMAs deep, but one multiplication more per level
+//   mixed:  Estrin for c2..cn, then the last two steps are Horner, p = c0 + x (c1 + x E(x)).
+//           2 FMAs deeper than Estrin, but the rounding is the one of Horner where it matters
+// in latency bound code (one value at a time, or a dependency chain) the short schemes win,
+// with independent elements the out-of-order engine overlaps Horner chains anyway and fewer
+// instructions win. It's the same polynomial, but not the same rounding: the error of a
+// Horner chain is mostly the one of its last FMA, for x small against 1 the low order terms
+// decide the result, and Estrin adds them to rounded partial sums. That cost atan and asin
+// 0.5 to 1 ULP, mixed doesn't
+
+namespace vecmath {
+
+enum class scheme { horner, estrin, mixed };
+
+template <float C0, float... Cs, typename V>
+inline V poly_eval(V x) {
+	if constexpr (sizeof...(Cs) == 0) {
+		return broadcast<V>(C0);
+	} else {
+		return fmadd(poly_eval<Cs...>(x), x, broadcast<V>(C0));
+	}
+}
+
+namespace detail {
+
+template <size_t I, typename V, size_t N>
+inline V estrin_pair(const std::array<V, N>& c, V x) {
+	if constexpr (I + 1 < N) return fmadd(c[I + 1], x, c[I]);
+	else return c[I];
+}
+
+template <typename V, size_t N>
+inline V estrin(const std::array<V, N>& c, V x) {
+	if constexpr (N == 1) {
+		return c[0];
+	} else {
+		std::array<V, (N + 1) / 2> d = [&]<size_t... I>(std::index_sequence<I...>) {
+			return std::array<V, (N + 1) / 2>{ estrin_pair<2 * I>(c, x)... };
+		}(std::make_index_sequence<(N + 1) / 2>{});
+		return estrin(d, mul(x, x));
+	}
+}
+
+}
+
+template <scheme S, float... Cs, typename V>
+inline V poly_eval(V x) {
+	if constexpr (S == scheme::horner || sizeof...(Cs) <= 2 || (S == scheme::mixed && sizeof...(Cs) <= 4)) {
+		return poly_eval<Cs...>(x);
+	} else {
+		std::array<V, sizeof...(Cs)> c = { broadcast<V>(Cs)... };
+		if constexpr (S == scheme::estrin) {
+			return detail::estrin(c, x);
+		} else {
+			std::array<V, sizeof...(Cs) - 2> tail = [&]<size_t... I>(std::index_sequence<I...>) {
+				return std::array<V, sizeof...(Cs) - 2>{ c[I + 2]... };
+			}(std::make_index_sequence<sizeof...(Cs) - 2>{});
+			return fmadd(fmadd(detail::estrin(tail, x), x, c[1]), x, c[0]);
+		}
+	}
+}
+
+// coefficient table as a type, so tables can be picked with a template parameter
+// (see exp2_coeffs<Degree>). c[] is there in case the coefficients are needed at runtime
+template <float... Cs>
+struct polynomial {
+	static constexpr size_t degree = sizeof...(Cs) - 1;
+	static constexpr float c[] = { Cs... };
+
+	template <scheme S = scheme::horner, typename V>
+	static V eval(V x) {
+		return poly_eval<S, Cs...>(x);
+	}
+};
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "exp.hpp"
+#include "log.hpp"
+
+
+
+// x^y = 2^(y * log2(x)), for x > 0 (same restrictions as log2). The absolute error of log2
+// gets multiplied by y, so the relative error of the result grows with |y * log2(x)|: with
+// Degree 5 it's about 2e-7 * (1 + 0.7 * |y * log2(x)|)
+
+namespace vecmath {
+
+template <int Degree = 5, typename V>
+inline V pow(V x, V y) {
+	return vecmath::exp2<Degree>(mul(y, vecmath::log2<Degree>(x)));
+}
+
+}
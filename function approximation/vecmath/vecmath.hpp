@@ -0,0 +1,24 @@
+#pragma once
+
+// header-only vector math library built on the approximations in exponentials/. Every
+// function takes a Degree template parameter (2 to 5, from fastest to most accurate) and
+// has float, __m256 (AVX2 + FMA) and __m512 (AVX-512F, if enabled) overloads:
+//
+//   vecmath::exp2<4>(x), vecmath::exp(x), vecmath::expm1(x), vecmath::log2(x),
+//   vecmath::log(x), vecmath::pow(x, y)
+//
+// always call them qualified: an unqualified exp2(1.0f) would pick the libm one. There are
+// also array versions (array.hpp) taking (const float* in, float* out, size_t n), and double
+// precision exp2_table / exp_table for double, __m256d and __m512d (exp_double.hpp). On top of
+// those, activations.hpp has sigmoid, silu, tanh, gelu and a row-wise softmax, and lut.hpp
+// turns any function into a lookup table with linear or cubic interpolation
+
+#include "common.hpp"
+#include "poly.hpp"
+#include "exp.hpp"
+#include "log.hpp"
+#include "pow.hpp"
+#include "exp_double.hpp"
+#include "array.hpp"
+#include "activations.hpp"
+#include "lut.hpp"
@@ -1,85 +1,300 @@
 #include <cmath>
 #include <vector>
+#include <random>
+#include <numbers>
+#include <algorithm>
 #include <benchmark/benchmark.h>
 #include "classical.hpp"
+#include "templated.hpp"
+#include "piecewise.hpp"
+#include "chebyshev.hpp"
 
 
 
+// arguments of every benchmark: {number of nodes, node distribution, number of evaluation points}
+enum Distribution { equispaced = 0, chebyshev = 1, uniform_random = 2 };
 
+static const char* distribution_names[] = { "equispaced", "chebyshev", "random" };
 
-static void naive(benchmark::State& state) {
 
-    double x_min = -3.14159265359;
-    double x_max = 3.14159265359;
-    int N_points = 1000;
 
-    std::vector<double> x; x.reserve(N_points);
-    std::vector<double> y; y.reserve(N_points);
-    for (int i = 0; i < N_points; ++i) {
-        double x_val = x_min + (x_max - x_min) * static_cast<double>(i) / static_cast<double>(N_points - 1);
-        x.push_back(x_val);
-        y.push_back(std::sin(x_val));
+struct Problem {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> eval_points;
+    std::vector<double> reference;
+};
+
+
+// barycentric interpolation in long double, O(n^2) once for the weights and then O(n)
+// per point, so it's cheap enough to compute for every configuration
+static long double reference_Lagrange(const std::vector<double>& x, const std::vector<double>& y, const std::vector<long double>& w, double a) {
+    long double num = 0.0L;
+    long double den = 0.0L;
+
+    for (size_t j = 0; j < x.size(); ++j) {
+        long double diff = static_cast<long double>(a) - x[j];
+        if (diff == 0.0L) return y[j];
+
+        long double t = w[j] / diff;
+        num += t * y[j];
+        den += t;
     }
 
-    double eval_point = 0.785398163397; // pi / 4
+    return num / den;
+}
 
-    for (auto _ : state) {
-        double result = naive_Lagrange(x, y, eval_point);
-        benchmark::DoNotOptimize(result);
+
+static const double x_min = -3.14159265359;
+static const double x_max = 3.14159265359;
+
+
+// sorted nodes in [x_min, x_max]
+static std::vector<double> make_nodes(int N_points, Distribution distribution, std::mt19937_64& gen) {
+    std::uniform_real_distribution<double> uniform(x_min, x_max);
+
+    std::vector<double> x;
+    x.reserve(N_points);
+    for (int i = 0; i < N_points; ++i) {
+        double t = static_cast<double>(i) / static_cast<double>(N_points - 1);
+
+        if (distribution == equispaced) x.push_back(x_min + (x_max - x_min) * t);
+        else if (distribution == chebyshev) x.push_back(0.5 * (x_max + x_min) - 0.5 * (x_max - x_min) * std::cos(std::numbers::pi * (i + 0.5) / N_points));
+        else x.push_back(uniform(gen));
     }
+    std::sort(x.begin(), x.end());
+
+    return x;
 }
-BENCHMARK(naive);
 
 
+static Problem make_problem(int N_points, Distribution distribution, int N_eval) {
 
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<double> uniform(x_min, x_max);
 
-static void SIMD(benchmark::State& state) {
+    Problem p;
+    p.x = make_nodes(N_points, distribution, gen);
 
-    double x_min = -3.14159265359;
-    double x_max = 3.14159265359;
-    int N_points = 1000;
+    p.y.reserve(N_points);
+    for (double x_val : p.x) p.y.push_back(std::sin(x_val));
 
-    std::vector<double> x; x.reserve(N_points);
-    std::vector<double> y; y.reserve(N_points);
-    for (int i = 0; i < N_points; ++i) {
-        double x_val = x_min + (x_max - x_min) * static_cast<double>(i) / static_cast<double>(N_points - 1);
-        x.push_back(x_val);
-        y.push_back(std::sin(x_val));
+    // a single point is always pi / 4, like the old benchmark
+    if (N_eval == 1) p.eval_points.push_back(0.785398163397);
+    else for (int i = 0; i < N_eval; ++i) p.eval_points.push_back(uniform(gen));
+
+    // the weights themselves under/overflow even in long double for a few thousand nodes, but
+    // any common factor cancels out in the barycentric formula, so build them as logarithms
+    std::vector<long double> log_w(N_points, 0.0L);
+    std::vector<int> sign(N_points, 1);
+    for (int j = 0; j < N_points; ++j) {
+        for (int i = 0; i < N_points; ++i) {
+            if (i == j) continue;
+            long double diff = static_cast<long double>(p.x[j]) - p.x[i];
+            log_w[j] -= std::log(std::abs(diff));
+            if (diff < 0.0L) sign[j] = -sign[j];
+        }
     }
 
-    double eval_point = 0.785398163397; // pi / 4
+    long double log_w_max = *std::max_element(log_w.begin(), log_w.end());
+    std::vector<long double> w(N_points);
+    for (int j = 0; j < N_points; ++j) w[j] = sign[j] * std::exp(log_w[j] - log_w_max);
+
+    for (double a : p.eval_points) p.reference.push_back(static_cast<double>(reference_Lagrange(p.x, p.y, w, a)));
+
+    return p;
+}
+
+
+
+
+// T is float only for the templated kernels, the problem and the reference stay in double
+template <typename T>
+static void interpolation(benchmark::State& state, T (*f)(const std::vector<T>&, const std::vector<T>&, T)) {
+
+    int N_points = static_cast<int>(state.range(0));
+    Distribution distribution = static_cast<Distribution>(state.range(1));
+    int N_eval = static_cast<int>(state.range(2));
+
+    Problem p = make_problem(N_points, distribution, N_eval);
+
+    std::vector<T> x(p.x.begin(), p.x.end());
+    std::vector<T> y(p.y.begin(), p.y.end());
+    std::vector<T> eval_points(p.eval_points.begin(), p.eval_points.end());
+
+    std::vector<T> results(N_eval);
 
     for (auto _ : state) {
-        double result = SIMD_Lagrange(x, y, eval_point);
-        benchmark::DoNotOptimize(result);
+        for (int i = 0; i < N_eval; ++i) {
+            results[i] = f(x, y, eval_points[i]);
+        }
+        benchmark::DoNotOptimize(results.data());
+        benchmark::ClobberMemory();
+    }
+
+    // NaN/inf should show up as such, so don't let std::max eat them
+    double max_err = 0.0;
+    for (int i = 0; i < N_eval; ++i) {
+        double err = std::abs(static_cast<double>(results[i]) - p.reference[i]);
+        if (!(err <= max_err)) max_err = err;
     }
+
+    state.SetItemsProcessed(state.iterations() * N_eval);
+    state.counters["max_err"] = max_err;
+    state.SetLabel(distribution_names[distribution]);
 }
-BENCHMARK(SIMD);
 
 
 
+// the interpolant as a truncated Chebyshev series, evaluated with SIMD_Clenshaw, against the
+// same reference as the rest. On Chebyshev nodes (direct) the samples are already what
+// Chebyshev_coefficients wants, just in the opposite order. Otherwise (resampled) it goes
+// through to_Chebyshev, which calls kernel_Lagrange for every Chebyshev node, so that one
+// only runs as far as naive. The conversion is done once and not timed, the truncated
+// degree is reported as a counter
+static void series(benchmark::State& state, bool resample) {
 
-static void kernel(benchmark::State& state) {
+    int N_points = static_cast<int>(state.range(0));
+    Distribution distribution = static_cast<Distribution>(state.range(1));
+    int N_eval = static_cast<int>(state.range(2));
 
-    double x_min = -3.14159265359;
-    double x_max = 3.14159265359;
-    int N_points = 1000;
+    Problem p = make_problem(N_points, distribution, N_eval);
 
-    std::vector<double> x; x.reserve(N_points);
-    std::vector<double> y; y.reserve(N_points);
-    for (int i = 0; i < N_points; ++i) {
-        double x_val = x_min + (x_max - x_min) * static_cast<double>(i) / static_cast<double>(N_points - 1);
-        x.push_back(x_val);
-        y.push_back(std::sin(x_val));
+    Chebyshev_series s;
+    if (resample) s = to_Chebyshev(p.x, p.y);
+    else s = Chebyshev_coefficients(std::vector<double>(p.y.rbegin(), p.y.rend()), x_min, x_max);
+    // the DCT leaves rounding noise of about sqrt(n) * eps in every coefficient, which a
+    // tighter tolerance would keep (with 4096 nodes, 1e-15 still keeps almost all of them)
+    truncate(s, 1e-13);
+
+    std::vector<double> results(N_eval);
+
+    for (auto _ : state) {
+        SIMD_Clenshaw(s, p.eval_points.data(), results.data(), N_eval);
+        benchmark::DoNotOptimize(results.data());
+        benchmark::ClobberMemory();
     }
 
-    double eval_point = 0.785398163397; // pi / 4
+    double max_err = 0.0;
+    for (int i = 0; i < N_eval; ++i) {
+        double err = std::abs(results[i] - p.reference[i]);
+        if (!(err <= max_err)) max_err = err;
+    }
+
+    state.SetItemsProcessed(state.iterations() * N_eval);
+    state.counters["max_err"] = max_err;
+    state.counters["degree"] = static_cast<double>(s.c.size() - 1);
+    state.SetLabel(distribution_names[distribution]);
+}
+
+
+// the global reference makes no sense for piecewise interpolation (and would take forever
+// for 100000 nodes), so this is the same window as Piecewise_Lagrange (the interval of a,
+// centered when possible), with the textbook formula in long double
+static double window_reference(const std::vector<double>& x, const std::vector<double>& y, size_t degree, double a) {
+    size_t n = x.size();
+    size_t k = std::min(degree + 1, n);
+
+    size_t i = std::upper_bound(x.begin(), x.end(), a) - x.begin();
+    i = std::clamp<size_t>(i, 1, n - 1) - 1;
+    size_t s = std::min((i + 1 >= k / 2) ? i + 1 - k / 2 : 0, n - k);
+
+    long double result = 0.0L;
+    for (size_t m = s; m < s + k; ++m) {
+        long double prod = y[m];
+        for (size_t l = s; l < s + k; ++l) {
+            if (l == m) continue;
+            prod *= (static_cast<long double>(a) - x[l]) / (static_cast<long double>(x[m]) - x[l]);
+        }
+        result += prod;
+    }
+
+    return static_cast<double>(result);
+}
+
+
+// arguments: {number of nodes, node distribution, degree}, always 4096 random points, one at a
+// time with operator()(double) or all of them with the batch operator(). The batch version
+// also reports how far it is from the scalar one (scalar_diff), they should agree to rounding
+static void piecewise(benchmark::State& state, bool batch) {
+
+    int N_points = static_cast<int>(state.range(0));
+    Distribution distribution = static_cast<Distribution>(state.range(1));
+    size_t degree = static_cast<size_t>(state.range(2));
+    const int N_eval = 4096;
+
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<double> uniform(x_min, x_max);
+
+    std::vector<double> x = make_nodes(N_points, distribution, gen);
+    std::vector<double> y;
+    for (double x_val : x) y.push_back(std::sin(x_val));
+
+    std::vector<double> eval_points(N_eval);
+    for (double& a : eval_points) a = uniform(gen);
+
+    Piecewise_Lagrange interpolant(x, y, degree);
+
+    std::vector<double> results(N_eval);
 
     for (auto _ : state) {
-        double result = kernel_Lagrange(x, y, eval_point);
-        benchmark::DoNotOptimize(result);
+        if (batch) {
+            interpolant(eval_points.data(), results.data(), N_eval);
+        } else {
+            for (int i = 0; i < N_eval; ++i) results[i] = interpolant(eval_points[i]);
+        }
+        benchmark::DoNotOptimize(results.data());
+        benchmark::ClobberMemory();
+    }
+
+    double max_err = 0.0;
+    double scalar_diff = 0.0;
+    for (int i = 0; i < N_eval; ++i) {
+        double err = std::abs(results[i] - window_reference(x, y, degree, eval_points[i]));
+        if (!(err <= max_err)) max_err = err;
+
+        double diff = std::abs(results[i] - interpolant(eval_points[i]));
+        if (!(diff <= scalar_diff)) scalar_diff = diff;
     }
+
+    state.SetItemsProcessed(state.iterations() * N_eval);
+    state.counters["max_err"] = max_err;
+    if (batch) state.counters["scalar_diff"] = scalar_diff;
+    state.SetLabel(distribution_names[distribution]);
+}
+
+
+
+// naive is O(n^2) with a division in the inner loop, so don't go as far with it
+static void naive_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "n", "dist", "points" });
+    b->ArgsProduct({ benchmark::CreateRange(8, 512, 4), { equispaced, chebyshev, uniform_random }, { 1, 64 } });
+}
+
+static void fast_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "n", "dist", "points" });
+    b->ArgsProduct({ benchmark::CreateRange(8, 4096, 8), { equispaced, chebyshev, uniform_random }, { 1, 64 } });
+}
+
+static void chebyshev_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "n", "dist", "points" });
+    b->ArgsProduct({ benchmark::CreateRange(8, 4096, 8), { chebyshev }, { 1, 64 } });
+}
+
+static void piecewise_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "n", "dist", "degree" });
+    b->ArgsProduct({ { 1000, 100000 }, { equispaced, chebyshev, uniform_random }, { 3, 7 } });
 }
-BENCHMARK(kernel);
+
+BENCHMARK_CAPTURE(interpolation, naive, naive_Lagrange)->Apply(naive_args);
+BENCHMARK_CAPTURE(interpolation, SIMD, SIMD_Lagrange)->Apply(fast_args);
+BENCHMARK_CAPTURE(interpolation, kernel, kernel_Lagrange)->Apply(fast_args);
+BENCHMARK_CAPTURE(interpolation, scaled, scaled_Lagrange)->Apply(fast_args);
+BENCHMARK_CAPTURE(interpolation, dispatch_double, dispatch_Lagrange<double>)->Apply(fast_args);
+BENCHMARK_CAPTURE(interpolation, dispatch_float, dispatch_Lagrange<float>)->Apply(fast_args);
+BENCHMARK_CAPTURE(series, direct, false)->Apply(chebyshev_args);
+BENCHMARK_CAPTURE(series, resampled, true)->Apply(naive_args);
+BENCHMARK_CAPTURE(piecewise, scalar, false)->Apply(piecewise_args);
+BENCHMARK_CAPTURE(piecewise, batch, true)->Apply(piecewise_args);
 
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+#include <x86intrin.h>
+
+#include "classical.hpp"
+
+
+
+// for smooth functions it's way better to store the interpolant as a Chebyshev series
+// sum c_k * T_k(t) (with a mapped to t in [-1, 1]) than as the nodes themselves: conversion
+// is O(n log n), and after dropping negligible coefficients evaluation is O(k) for the
+// truncated degree k, instead of the O(n^2) of kernel_Lagrange
+struct Chebyshev_series {
+	std::vector<double> c;
+	double x_min;
+	double x_max;
+};
+
+
+
+// Chebyshev nodes of the first kind mapped to [x_min, x_max]. They come out in decreasing
+// order (x_j = cos(pi * (j + 0.5) / n)), which is the order Chebyshev_coefficients expects
+std::vector<double> Chebyshev_nodes(size_t n, double x_min, double x_max) {
+	std::vector<double> x(n);
+
+	double mid = 0.5 * (x_max + x_min);
+	double half = 0.5 * (x_max - x_min);
+
+	for (size_t j = 0; j < n; ++j) {
+		x[j] = mid + half * std::cos(std::numbers::pi * (static_cast<double>(j) + 0.5) / static_cast<double>(n));
+	}
+
+	return x;
+}
+
+
+
+
+// plain iterative radix-2 FFT, n must be a power of 2
+void FFT(std::vector<std::complex<double>>& v) {
+	size_t n = v.size();
+
+	// bit reversal permutation
+	for (size_t i = 1, j = 0; i < n; ++i) {
+		size_t bit = n >> 1;
+		for (; j & bit; bit >>= 1) j ^= bit;
+		j ^= bit;
+
+		if (i < j) std::swap(v[i], v[j]);
+	}
+
+	for (size_t len = 2; len <= n; len <<= 1) {
+		double angle = -2.0 * std::numbers::pi / static_cast<double>(len);
+		std::complex<double> w_len(std::cos(angle), std::sin(angle));
+
+		for (size_t i = 0; i < n; i += len) {
+			std::complex<double> w(1.0, 0.0);
+			for (size_t k = 0; k < len / 2; ++k) {
+				std::complex<double> u = v[i + k];
+				std::complex<double> t = v[i + k + len / 2] * w;
+				v[i + k] = u + t;
+				v[i + k + len / 2] = u - t;
+				w *= w_len;
+			}
+		}
+	}
+}
+
+
+// DCT-II (X_k = sum_j y_j * cos(pi * k * (2j + 1) / 2n)) using Makhoul's trick: reorder
+// the input as [y_0, y_2, y_4, ..., y_5, y_3, y_1], take an FFT of the same length and
+// rotate each output by exp(-i * pi * k / 2n). If n is not a power of 2 we just do the
+// O(n^2) sum, I don't feel like writing a mixed radix FFT for this
+std::vector<double> DCT_II(const std::vector<double>& y) {
+	size_t n = y.size();
+	std::vector<double> X(n);
+
+	if (n == 0 || (n & (n - 1)) != 0) {
+		for (size_t k = 0; k < n; ++k) {
+			double s = 0.0;
+			for (size_t j = 0; j < n; ++j) {
+				s += y[j] * std::cos(std::numbers::pi * static_cast<double>(k * (2 * j + 1)) / static_cast<double>(2 * n));
+			}
+			X[k] = s;
+		}
+
+		return X;
+	}
+
+	std::vector<std::complex<double>> v(n);
+	for (size_t j = 0; j < n / 2; ++j) {
+		v[j] = y[2 * j];
+		v[n - 1 - j] = y[2 * j + 1];
+	}
+	if (n == 1) v[0] = y[0];
+
+	FFT(v);
+
+	for (size_t k = 0; k < n; ++k) {
+		double angle = -std::numbers::pi * static_cast<double>(k) / static_cast<double>(2 * n);
+		X[k] = (v[k] * std::complex<double>(std::cos(angle), std::sin(angle))).real();
+	}
+
+	return X;
+}
+
+
+
+
+// y must be sampled at Chebyshev_nodes(y.size(), x_min, x_max)
+Chebyshev_series Chebyshev_coefficients(const std::vector<double>& y, double x_min, double x_max) {
+	size_t n = y.size();
+
+	Chebyshev_series s{ DCT_II(y), x_min, x_max };
+
+	double scale = 2.0 / static_cast<double>(n);
+	for (double& c : s.c) c *= scale;
+	if (n > 0) s.c[0] *= 0.5;
+
+	return s;
+}
+
+// for arbitrary nodes we first resample the interpolant at n_cheb Chebyshev nodes (one
+// kernel_Lagrange call per node, so this is O(n^2 * n_cheb) once, but only once). If
+// n_cheb is 0 we use the next power of 2 >= x.size(), so the DCT takes the fast path
+Chebyshev_series to_Chebyshev(const std::vector<double>& x, const std::vector<double>& y, size_t n_cheb = 0) {
+	auto [x_min_it, x_max_it] = std::minmax_element(x.begin(), x.end());
+	double x_min = *x_min_it;
+	double x_max = *x_max_it;
+
+	if (n_cheb == 0) {
+		n_cheb = 1;
+		while (n_cheb < x.size()) n_cheb <<= 1;
+	}
+
+	std::vector<double> nodes = Chebyshev_nodes(n_cheb, x_min, x_max);
+	std::vector<double> values(n_cheb);
+	for (size_t j = 0; j < n_cheb; ++j) {
+		values[j] = kernel_Lagrange(x, y, nodes[j]);
+	}
+
+	return Chebyshev_coefficients(values, x_min, x_max);
+}
+
+
+// drops trailing coefficients smaller than tol (relative to the largest one). For smooth
+// functions they decay exponentially, so this usually leaves only a small fraction of them
+void truncate(Chebyshev_series& s, double tol) {
+	double c_max = 0.0;
+	for (double c : s.c) c_max = std::max(c_max, std::abs(c));
+
+	size_t k = s.c.size();
+	while (k > 1 && std::abs(s.c[k - 1]) <= tol * c_max) --k;
+
+	s.c.resize(k);
+}
+
+
+
+
+double Clenshaw(const Chebyshev_series& s, double a) {
+	size_t k = s.c.size();
+	if (k == 0) return 0.0;
+
+	double t = (2.0 * a - (s.x_max + s.x_min)) / (s.x_max - s.x_min);
+	double two_t = 2.0 * t;
+
+	double b1 = 0.0;
+	double b2 = 0.0;
+	for (size_t i = k - 1; i > 0; --i) {
+		double b0 = s.c[i] + two_t * b1 - b2;
+		b2 = b1;
+		b1 = b0;
+	}
+
+	return s.c[0] + t * b1 - b2;
+}
+
+
+// evaluates 8 points at a time (two independent recurrences, since each step of a single
+// one depends on the last and would leave most of the FMA units idle)
+void SIMD_Clenshaw(const Chebyshev_series& s, const double* a, double* out, size_t n) {
+	size_t k = s.c.size();
+	if (k == 0) {
+		std::fill(out, out + n, 0.0);
+		return;
+	}
+
+	double scale = 2.0 / (s.x_max - s.x_min);
+	__m256d v_scale = _mm256_set1_pd(scale);
+	__m256d v_shift = _mm256_set1_pd(-(s.x_max + s.x_min) / (s.x_max - s.x_min));
+
+	size_t p;
+	for (p = 0; p + 7 < n; p += 8) {
+		__m256d t1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + p), v_scale, v_shift);
+		__m256d t2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + p + 4), v_scale, v_shift);
+		__m256d two_t1 = _mm256_add_pd(t1, t1);
+		__m256d two_t2 = _mm256_add_pd(t2, t2);
+
+		__m256d b1_1 = _mm256_setzero_pd(), b2_1 = _mm256_setzero_pd();
+		__m256d b1_2 = _mm256_setzero_pd(), b2_2 = _mm256_setzero_pd();
+
+		for (size_t i = k - 1; i > 0; --i) {
+			__m256d c = _mm256_set1_pd(s.c[i]);
+			__m256d b0_1 = _mm256_fmadd_pd(two_t1, b1_1, _mm256_sub_pd(c, b2_1));
+			__m256d b0_2 = _mm256_fmadd_pd(two_t2, b1_2, _mm256_sub_pd(c, b2_2));
+			b2_1 = b1_1; b1_1 = b0_1;
+			b2_2 = b1_2; b1_2 = b0_2;
+		}
+
+		__m256d c0 = _mm256_set1_pd(s.c[0]);
+		_mm256_storeu_pd(out + p, _mm256_fmadd_pd(t1, b1_1, _mm256_sub_pd(c0, b2_1)));
+		_mm256_storeu_pd(out + p + 4, _mm256_fmadd_pd(t2, b1_2, _mm256_sub_pd(c0, b2_2)));
+	}
+
+	for (; p < n; ++p) {
+		out[p] = Clenshaw(s, a[p]);
+	}
+}
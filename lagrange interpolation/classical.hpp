@@ -1,4 +1,9 @@
+#pragma once
+
 #include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
 #include <x86intrin.h>
 
 
@@ -227,5 +232,174 @@ double kernel_Lagrange(const std::vector<double>& x, const std::vector<double>&
 		result += scalar_num / scalar_den;
 	}
 
+	return result;
+}
+
+
+
+
+// for large n (a few thousands), the products in kernel_Lagrange overflow or underflow
+// (depending on how close together the points are), and the result becomes inf/NaN. Here
+// we keep every product as m * 2^e, and every few multiplications we move the exponent
+// bits of m into e, so m always stays in [1, 2). Zeros (a == x[i]) are kept as zeros
+inline void renormalize(__m256d& m, __m256i& e) {
+	const __m256i exp_mask = _mm256_set1_epi64x(0x7FF0000000000000);
+	const __m256i one_bits = _mm256_set1_epi64x(0x3FF0000000000000);
+	const __m256i bias = _mm256_set1_epi64x(1023);
+
+	__m256i bits = _mm256_castpd_si256(m);
+	__m256i exp_bits = _mm256_and_si256(bits, exp_mask);
+	__m256i zero = _mm256_cmpeq_epi64(exp_bits, _mm256_setzero_si256());
+
+	// replace exponent bits by the ones of 1.0 (sign and mantissa stay the same)
+	__m256i m_bits = _mm256_or_si256(_mm256_andnot_si256(exp_mask, bits), one_bits);
+	m = _mm256_castsi256_pd(_mm256_andnot_si256(zero, m_bits));
+
+	__m256i exponent = _mm256_sub_epi64(_mm256_srli_epi64(exp_bits, 52), bias);
+	e = _mm256_add_epi64(e, _mm256_andnot_si256(zero, exponent));
+}
+
+inline int64_t hsum_256(__m256i v) {
+	__m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	return _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+}
+
+
+// each lane gets multiplied by one factor per iteration, so renormalizing every 32 of them
+// only breaks if the factors are bigger than 2^31 (or smaller than 2^-31) on average.
+// Doing it more often is safer, but it gets noticeably slower
+static constexpr int renormalize_every = 32;
+
+// handles the products of B consecutive nodes starting at j (B = 1 for the tail)
+template <size_t B>
+double scaled_block(const std::vector<double>& x, const std::vector<double>& y, double a, size_t j) {
+	size_t n = x.size();
+
+	__m256d v_a = _mm256_set1_pd(a);
+
+	double xj[B];
+	__m256d v_xj[B];
+	__m256d v_num_prod[B];
+	__m256d v_den_prod[B];
+	__m256i v_num_exp[B];
+	__m256i v_den_exp[B];
+
+	double scalar_num[B];
+	double scalar_den[B];
+	int64_t scalar_exp[B];
+
+	for (size_t k = 0; k < B; ++k) {
+		xj[k] = x[j + k];
+		v_xj[k] = _mm256_set1_pd(xj[k]);
+		v_num_prod[k] = _mm256_set1_pd(1.0);
+		v_den_prod[k] = _mm256_set1_pd(1.0);
+		v_num_exp[k] = _mm256_setzero_si256();
+		v_den_exp[k] = _mm256_setzero_si256();
+
+		scalar_num[k] = y[j + k];
+		scalar_den[k] = 1.0;
+		scalar_exp[k] = 0;
+	}
+
+	auto renormalize_all = [&]() {
+		for (size_t k = 0; k < B; ++k) {
+			renormalize(v_den_prod[k], v_den_exp[k]);
+			renormalize(v_num_prod[k], v_num_exp[k]);
+		}
+	};
+
+	// scalar leftovers are at most 3 + B factors on each side, so a frexp after each is enough
+	auto fold_scalars = [&]() {
+		for (size_t k = 0; k < B; ++k) {
+			int e_num, e_den;
+			scalar_num[k] = std::frexp(scalar_num[k], &e_num);
+			scalar_den[k] = std::frexp(scalar_den[k], &e_den);
+			scalar_exp[k] += e_num - e_den;
+		}
+	};
+
+	// handle i < j
+	size_t i = 0;
+	while (i + 3 < j) {
+		size_t end = std::min(j, i + 4 * renormalize_every);
+		for (; i + 3 < end; i += 4) {
+			__m256d v_xi = _mm256_loadu_pd(&x[i]);
+			__m256d v_delta_a = _mm256_sub_pd(v_a, v_xi);
+			for (size_t k = 0; k < B; ++k) {
+				v_den_prod[k] = _mm256_mul_pd(v_den_prod[k], _mm256_sub_pd(v_xj[k], v_xi));
+				v_num_prod[k] = _mm256_mul_pd(v_num_prod[k], v_delta_a);
+			}
+		}
+		renormalize_all();
+	}
+	for (; i < j + B; ++i) {
+		double xi = x[i];
+		double delta_a = a - xi;
+		for (size_t k = 0; k < B; ++k) {
+			if (i == j + k) continue;
+			scalar_den[k] *= (xj[k] - xi);
+			scalar_num[k] *= delta_a;
+		}
+	}
+	fold_scalars();
+
+	// handle i > j
+	i = j + B;
+	while (i + 3 < n) {
+		size_t end = std::min(n, i + 4 * renormalize_every);
+		for (; i + 3 < end; i += 4) {
+			__m256d v_xi = _mm256_loadu_pd(&x[i]);
+			__m256d v_delta_a = _mm256_sub_pd(v_a, v_xi);
+			for (size_t k = 0; k < B; ++k) {
+				v_den_prod[k] = _mm256_mul_pd(v_den_prod[k], _mm256_sub_pd(v_xj[k], v_xi));
+				v_num_prod[k] = _mm256_mul_pd(v_num_prod[k], v_delta_a);
+			}
+		}
+		renormalize_all();
+	}
+	for (; i < n; ++i) {
+		double xi = x[i];
+		double delta_a = a - xi;
+		for (size_t k = 0; k < B; ++k) {
+			scalar_den[k] *= (xj[k] - xi);
+			scalar_num[k] *= delta_a;
+		}
+	}
+	fold_scalars();
+
+	double result = 0.0;
+	renormalize_all();
+	for (size_t k = 0; k < B; ++k) {
+		// the mantissas are all in [1, 2), so their product can't overflow
+		double num = scalar_num[k] * hmul_256(v_num_prod[k]);
+		double den = scalar_den[k] * hmul_256(v_den_prod[k]);
+		int64_t e = scalar_exp[k] + hsum_256(v_num_exp[k]) - hsum_256(v_den_exp[k]);
+
+		result += std::ldexp(num / den, static_cast<int>(std::clamp<int64_t>(e, -4096, 4096)));
+	}
+
+	return result;
+}
+
+
+// same as kernel_Lagrange, but overflow-safe. It's about 1.5x slower (mostly because of the
+// renormalizations), but works for node counts in the thousands, where kernel_Lagrange
+// returns inf/NaN and naive_Lagrange is hopelessly slow
+double scaled_Lagrange(const std::vector<double>& x, const std::vector<double>& y, double a) {
+	size_t n = x.size();
+
+	static constexpr size_t B = 6;
+
+	double result = 0.0;
+
+	size_t j;
+	for (j = 0; j + B - 1 < n; j += B) {
+		result += scaled_block<B>(x, y, a, j);
+	}
+
+	for (; j < n; ++j) {
+		result += scaled_block<1>(x, y, a, j);
+	}
+
 	return result;
 }
\ No newline at end of file
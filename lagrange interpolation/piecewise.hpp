@@ -0,0 +1,220 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <x86intrin.h>
+
+
+
+// for large tables a single global polynomial is both slow and numerically useless, so
+// here every query point only uses the degree + 1 nodes around it (a "window"). Finding
+// the interval is O(1) if the nodes are equally spaced, and a branchless binary search
+// otherwise (4 queries at a time with AVX2 gathers for batches).
+//
+// the interpolant on each window is sum_m c_m * prod_{l != m} (a - x_{s + l}), where
+// c_m = y_{s + m} / prod_{l != m} (x_{s + m} - x_{s + l}) is precomputed for every window
+// start s. The products are built with prefix/suffix products, so there's no division
+// and nothing special happens when a is exactly on a node.
+class Piecewise_Lagrange {
+public:
+
+	static constexpr size_t max_degree = 15;
+
+	// x must be sorted (and have at least 2 points). The degree gets clamped to x.size() - 1
+	Piecewise_Lagrange(const std::vector<double>& x, const std::vector<double>& y, size_t degree = 3) : x(x) {
+		size_t n = x.size();
+		k = std::min(std::min(degree, max_degree) + 1, n);
+
+		x_min = x.front();
+		h = (x.back() - x.front()) / static_cast<double>(n - 1);
+		inv_h = 1.0 / h;
+
+		// equally spaced up to rounding errors (like x_min + i * h)
+		uniform = true;
+		for (size_t i = 0; i < n; ++i) {
+			if (std::abs(x[i] - (x_min + static_cast<double>(i) * h)) > 1e-12 * (x.back() - x.front())) {
+				uniform = false;
+				break;
+			}
+		}
+
+		// on uniform grids the factors are computed as (u - l) with u = (a - x[s]) / h, so
+		// the weights don't depend on the window and h can be left out of them completely
+		size_t windows = n - k + 1;
+		c.resize(windows * k);
+		for (size_t s = 0; s < windows; ++s) {
+			for (size_t m = 0; m < k; ++m) {
+				double den = 1.0;
+				for (size_t l = 0; l < k; ++l) {
+					if (l == m) continue;
+					den *= uniform ? static_cast<double>(m) - static_cast<double>(l) : x[s + m] - x[s + l];
+				}
+				c[s * k + m] = y[s + m] / den;
+			}
+		}
+	}
+
+
+
+	double operator()(double a) const {
+		size_t s = window(interval(a));
+		const double* cs = &c[s * k];
+
+		double f[max_degree + 1];
+		if (uniform) {
+			double u = (a - x_min) * inv_h - static_cast<double>(s);
+			for (size_t l = 0; l < k; ++l) f[l] = u - static_cast<double>(l);
+		} else {
+			for (size_t l = 0; l < k; ++l) f[l] = a - x[s + l];
+		}
+
+		// prefix[m] = f[0] * ... * f[m - 1], suffix gets built on the way back
+		double prefix[max_degree + 1];
+		prefix[0] = 1.0;
+		for (size_t m = 1; m < k; ++m) prefix[m] = prefix[m - 1] * f[m - 1];
+
+		double result = 0.0;
+		double suffix = 1.0;
+		for (size_t m = k; m-- > 0;) {
+			result += cs[m] * prefix[m] * suffix;
+			suffix *= f[m];
+		}
+
+		return result;
+	}
+
+
+	// batch evaluation, 4 queries at a time (each lane can be in a different window, so
+	// the weights and nodes are gathered)
+	void operator()(const double* a, double* out, size_t n) const {
+		const __m256d v_one = _mm256_set1_pd(1.0);
+		const __m256d v_x_min = _mm256_set1_pd(x_min);
+		const __m256d v_inv_h = _mm256_set1_pd(inv_h);
+
+		size_t p;
+		for (p = 0; p + 3 < n; p += 4) {
+			__m256d v_a = _mm256_loadu_pd(a + p);
+			__m256i s = SIMD_window(SIMD_interval(v_a));
+			__m256i c_index = _mm256_mul_epu32(s, _mm256_set1_epi64x(static_cast<int64_t>(k)));
+
+			__m256d f[max_degree + 1];
+			if (uniform) {
+				__m256d u = _mm256_sub_pd(_mm256_mul_pd(_mm256_sub_pd(v_a, v_x_min), v_inv_h), to_pd(s));
+				for (size_t l = 0; l < k; ++l) f[l] = _mm256_sub_pd(u, _mm256_set1_pd(static_cast<double>(l)));
+			} else {
+				for (size_t l = 0; l < k; ++l) {
+					__m256i idx = _mm256_add_epi64(s, _mm256_set1_epi64x(static_cast<int64_t>(l)));
+					f[l] = _mm256_sub_pd(v_a, _mm256_i64gather_pd(x.data(), idx, 8));
+				}
+			}
+
+			__m256d prefix[max_degree + 1];
+			prefix[0] = v_one;
+			for (size_t m = 1; m < k; ++m) prefix[m] = _mm256_mul_pd(prefix[m - 1], f[m - 1]);
+
+			__m256d result = _mm256_setzero_pd();
+			__m256d suffix = v_one;
+			for (size_t m = k; m-- > 0;) {
+				__m256i idx = _mm256_add_epi64(c_index, _mm256_set1_epi64x(static_cast<int64_t>(m)));
+				__m256d cm = _mm256_i64gather_pd(c.data(), idx, 8);
+				result = _mm256_fmadd_pd(_mm256_mul_pd(cm, prefix[m]), suffix, result);
+				suffix = _mm256_mul_pd(suffix, f[m]);
+			}
+
+			_mm256_storeu_pd(out + p, result);
+		}
+
+		for (; p < n; ++p) {
+			out[p] = (*this)(a[p]);
+		}
+	}
+
+
+private:
+
+	std::vector<double> x;
+	std::vector<double> c;
+	size_t k;
+
+	bool uniform;
+	double x_min, h, inv_h;
+
+
+
+	// i such that x[i] <= a < x[i + 1] (clamped to [0, n - 2], so it extrapolates outside)
+	size_t interval(double a) const {
+		size_t n = x.size();
+
+		if (uniform) {
+			double t = std::floor((a - x_min) * inv_h);
+			if (!(t >= 0.0)) t = 0.0; // NaN too, like _mm256_max_pd does, casting it to size_t is UB
+			t = std::clamp(t, 0.0, static_cast<double>(n - 2));
+			return static_cast<size_t>(t);
+		}
+
+		// branchless binary search, the compiler turns the ternary into a cmov
+		const double* base = x.data();
+		size_t len = n - 1;
+		while (len > 1) {
+			size_t half = len / 2;
+			base = (base[half] <= a) ? base + half : base;
+			len -= half;
+		}
+
+		return static_cast<size_t>(base - x.data());
+	}
+
+	// first node of the window used for interval i, centered on it when possible
+	size_t window(size_t i) const {
+		size_t n = x.size();
+		size_t s = (i + 1 >= k / 2) ? i + 1 - k / 2 : 0;
+		return std::min(s, n - k);
+	}
+
+
+	static __m256d to_pd(__m256i v) {
+		// exact for integers < 2^52: put them in the mantissa of 2^52 and subtract 2^52
+		const __m256d magic = _mm256_set1_pd(4503599627370496.0);
+		return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(v, _mm256_castpd_si256(magic))), magic);
+	}
+
+	__m256i SIMD_interval(__m256d v_a) const {
+		size_t n = x.size();
+
+		if (uniform) {
+			__m256d t = _mm256_floor_pd(_mm256_mul_pd(_mm256_sub_pd(v_a, _mm256_set1_pd(x_min)), _mm256_set1_pd(inv_h)));
+			t = _mm256_min_pd(_mm256_max_pd(t, _mm256_setzero_pd()), _mm256_set1_pd(static_cast<double>(n - 2)));
+
+			// same magic number trick, backwards
+			const __m256d magic = _mm256_set1_pd(4503599627370496.0);
+			return _mm256_xor_si256(_mm256_castpd_si256(_mm256_add_pd(t, magic)), _mm256_castpd_si256(magic));
+		}
+
+		// same as the scalar version, but every lane searches its own query
+		__m256i base = _mm256_setzero_si256();
+		size_t len = n - 1;
+		while (len > 1) {
+			size_t half = len / 2;
+			__m256i mid = _mm256_add_epi64(base, _mm256_set1_epi64x(static_cast<int64_t>(half)));
+			__m256d x_mid = _mm256_i64gather_pd(x.data(), mid, 8);
+			__m256i go_right = _mm256_castpd_si256(_mm256_cmp_pd(x_mid, v_a, _CMP_LE_OQ));
+			base = _mm256_blendv_epi8(base, mid, go_right);
+			len -= half;
+		}
+
+		return base;
+	}
+
+	__m256i SIMD_window(__m256i i) const {
+		size_t n = x.size();
+
+		// s = clamp(i + 1 - k / 2, 0, n - k), done in signed 64 bit
+		__m256i s = _mm256_sub_epi64(i, _mm256_set1_epi64x(static_cast<int64_t>(k / 2) - 1));
+		s = _mm256_andnot_si256(_mm256_cmpgt_epi64(_mm256_setzero_si256(), s), s);
+
+		__m256i s_max = _mm256_set1_epi64x(static_cast<int64_t>(n - k));
+		return _mm256_blendv_epi8(s, s_max, _mm256_cmpgt_epi64(s, s_max));
+	}
+};
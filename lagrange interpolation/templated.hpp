@@ -0,0 +1,169 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <x86intrin.h>
+
+
+
+// kernel_Lagrange is hard-wired to double and AVX2. Here the same micro-kernel is written
+// once (templated_kernel.inl) for any scalar type and compiled for each ISA by including
+// it inside a #pragma GCC target region, so this header doesn't need -march=native and a
+// single binary can pick the best version for the CPU it runs on (see dispatch_Lagrange).
+// Floats get twice the lanes, but their products overflow a lot sooner, so keep n small
+
+
+
+namespace templated {
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+namespace avx2 {
+
+	template <typename T> struct simd;
+
+	template <> struct simd<double> {
+		using type = __m256d;
+		static constexpr size_t width = 4;
+
+		static type set1(double a) { return _mm256_set1_pd(a); }
+		static type loadu(const double* p) { return _mm256_loadu_pd(p); }
+		static type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+		static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+
+		static double hmul(type v) {
+			__m128d p = _mm_mul_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+			return _mm_cvtsd_f64(_mm_mul_sd(p, _mm_unpackhi_pd(p, p)));
+		}
+	};
+
+	template <> struct simd<float> {
+		using type = __m256;
+		static constexpr size_t width = 8;
+
+		static type set1(float a) { return _mm256_set1_ps(a); }
+		static type loadu(const float* p) { return _mm256_loadu_ps(p); }
+		static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+		static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+
+		static float hmul(type v) {
+			__m128 p = _mm_mul_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+			p = _mm_mul_ps(p, _mm_movehl_ps(p, p));
+			return _mm_cvtss_f32(_mm_mul_ss(p, _mm_shuffle_ps(p, p, 0b01)));
+		}
+	};
+
+	// 16 registers: 12 for the products and the rest for x[i], a - x[i] and so on
+	static constexpr size_t B = 6;
+
+	#include "templated_kernel.inl"
+}
+#pragma GCC pop_options
+
+
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx2,fma")
+
+// GCC 12 complains about _mm256_undefined_pd inside _mm512_extractf64x4_pd when it's
+// compiled through the target pragma. It's a false positive
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+namespace avx512 {
+
+	template <typename T> struct simd;
+
+	template <> struct simd<double> {
+		using type = __m512d;
+		static constexpr size_t width = 8;
+
+		static type set1(double a) { return _mm512_set1_pd(a); }
+		static type loadu(const double* p) { return _mm512_loadu_pd(p); }
+		static type sub(type a, type b) { return _mm512_sub_pd(a, b); }
+		static type mul(type a, type b) { return _mm512_mul_pd(a, b); }
+
+		// multiply both 256 bit halves together and then do the usual AVX reduction
+		static double hmul(type v) {
+			__m256d h = _mm256_mul_pd(_mm512_castpd512_pd256(v), _mm512_extractf64x4_pd(v, 1));
+			__m128d p = _mm_mul_pd(_mm256_castpd256_pd128(h), _mm256_extractf128_pd(h, 1));
+			return _mm_cvtsd_f64(_mm_mul_sd(p, _mm_unpackhi_pd(p, p)));
+		}
+	};
+
+	template <> struct simd<float> {
+		using type = __m512;
+		static constexpr size_t width = 16;
+
+		static type set1(float a) { return _mm512_set1_ps(a); }
+		static type loadu(const float* p) { return _mm512_loadu_ps(p); }
+		static type sub(type a, type b) { return _mm512_sub_ps(a, b); }
+		static type mul(type a, type b) { return _mm512_mul_ps(a, b); }
+
+		// _mm512_extractf32x8_ps needs AVX512DQ, so extract it as doubles instead
+		static float hmul(type v) {
+			__m256 high = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1));
+			__m256 h = _mm256_mul_ps(_mm512_castps512_ps256(v), high);
+			__m128 p = _mm_mul_ps(_mm256_castps256_ps128(h), _mm256_extractf128_ps(h, 1));
+			p = _mm_mul_ps(p, _mm_movehl_ps(p, p));
+			return _mm_cvtss_f32(_mm_mul_ss(p, _mm_shuffle_ps(p, p, 0b01)));
+		}
+	};
+
+	// 32 registers, so the micro-kernel can be bigger. 12 would still fit, but then the
+	// scalar tails start to dominate for a few hundred points, and 8 was faster everywhere
+	static constexpr size_t B = 8;
+
+	#include "templated_kernel.inl"
+}
+
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+
+}
+
+
+
+// fallback for CPUs without AVX2, same as naive_Lagrange
+template <typename T>
+T generic_Lagrange(const std::vector<T>& x, const std::vector<T>& y, T a) {
+
+	size_t n = x.size();
+	T res = T(0);
+
+	for (size_t i = 0; i < n; ++i) {
+		T prod = y[i];
+
+		for (size_t j = 0; j < n; ++j) {
+			if (j == i) continue;
+
+			prod *= (a - x[j]) / (x[i] - x[j]);
+		}
+
+		res += prod;
+	}
+
+	return res;
+}
+
+
+template <typename T>
+using Lagrange_func = T (*)(const std::vector<T>&, const std::vector<T>&, T);
+
+template <typename T>
+Lagrange_func<T> select_Lagrange() {
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx512f")) return templated::avx512::kernel_Lagrange<T>;
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return templated::avx2::kernel_Lagrange<T>;
+
+	return generic_Lagrange<T>;
+}
+
+// the CPU is only checked on the first call, after that it's just an indirect call
+template <typename T>
+T dispatch_Lagrange(const std::vector<T>& x, const std::vector<T>& y, T a) {
+	static const Lagrange_func<T> f = select_Lagrange<T>();
+	return f(x, y, a);
+}
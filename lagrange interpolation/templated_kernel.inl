@@ -0,0 +1,102 @@
+// generic version of kernel_Lagrange. This file gets included once per ISA by templated.hpp,
+// inside a namespace that provides simd<T> (the vector type and operations for T) and B (the
+// micro-kernel size). Don't include it directly
+
+
+
+// handles the products of Bk consecutive nodes starting at j (Bk = 1 for the tail)
+template <typename T, size_t Bk>
+T kernel_block(const std::vector<T>& x, const std::vector<T>& y, T a, size_t j) {
+	using V = simd<T>;
+	using vec = typename V::type;
+	static constexpr size_t W = V::width;
+
+	size_t n = x.size();
+
+	vec v_a = V::set1(a);
+
+	T xj[Bk];
+	vec v_xj[Bk];
+	vec v_num_prod[Bk];
+	vec v_den_prod[Bk];
+
+	T scalar_num[Bk];
+	T scalar_den[Bk];
+
+	for (size_t k = 0; k < Bk; ++k) {
+		xj[k] = x[j + k];
+		v_xj[k] = V::set1(xj[k]);
+		v_num_prod[k] = V::set1(T(1));
+		v_den_prod[k] = V::set1(T(1));
+
+		scalar_num[k] = y[j + k];
+		scalar_den[k] = T(1);
+	}
+
+	// handle i < j
+	size_t i;
+	for (i = 0; i + W - 1 < j; i += W) {
+		vec v_xi = V::loadu(&x[i]);
+		vec v_delta_a = V::sub(v_a, v_xi);
+		for (size_t k = 0; k < Bk; ++k) {
+			v_den_prod[k] = V::mul(v_den_prod[k], V::sub(v_xj[k], v_xi));
+			v_num_prod[k] = V::mul(v_num_prod[k], v_delta_a);
+		}
+	}
+	for (; i < j + Bk; ++i) {
+		T xi = x[i];
+		T delta_a = a - xi;
+		for (size_t k = 0; k < Bk; ++k) {
+			if (i == j + k) continue;
+			scalar_den[k] *= (xj[k] - xi);
+			scalar_num[k] *= delta_a;
+		}
+	}
+
+	// handle i > j
+	for (i = j + Bk; i + W - 1 < n; i += W) {
+		vec v_xi = V::loadu(&x[i]);
+		vec v_delta_a = V::sub(v_a, v_xi);
+		for (size_t k = 0; k < Bk; ++k) {
+			v_den_prod[k] = V::mul(v_den_prod[k], V::sub(v_xj[k], v_xi));
+			v_num_prod[k] = V::mul(v_num_prod[k], v_delta_a);
+		}
+	}
+	for (; i < n; ++i) {
+		T xi = x[i];
+		T delta_a = a - xi;
+		for (size_t k = 0; k < Bk; ++k) {
+			scalar_den[k] *= (xj[k] - xi);
+			scalar_num[k] *= delta_a;
+		}
+	}
+
+	T result = T(0);
+	for (size_t k = 0; k < Bk; ++k) {
+		scalar_num[k] *= V::hmul(v_num_prod[k]);
+		scalar_den[k] *= V::hmul(v_den_prod[k]);
+
+		result += scalar_num[k] / scalar_den[k];
+	}
+
+	return result;
+}
+
+
+template <typename T>
+T kernel_Lagrange(const std::vector<T>& x, const std::vector<T>& y, T a) {
+	size_t n = x.size();
+
+	T result = T(0);
+
+	size_t j;
+	for (j = 0; j + B - 1 < n; j += B) {
+		result += kernel_block<T, B>(x, y, a, j);
+	}
+
+	for (; j < n; ++j) {
+		result += kernel_block<T, 1>(x, y, a, j);
+	}
+
+	return result;
+}
@@ -2,39 +2,13 @@
 #include <x86intrin.h>
 
 #include "../../rng.h"
+#include "../bench/bench.hpp"
 
 using namespace std;
 
 
 
 
-struct Timer {
-
-    std::chrono::high_resolution_clock::time_point start_time;
-    std::chrono::high_resolution_clock::time_point end_time;
-
-
-    void start() {
-        start_time = std::chrono::high_resolution_clock::now();
-    }
-
-    void stop() {
-        end_time = std::chrono::high_resolution_clock::now();
-    }
-
-
-    double elapsedTime() const {
-        return std::chrono::duration<double, std::milli>(end_time - start_time).count();
-    }
-
-    void displayTime() const {
-        std::cout << "Elapsed time: " << elapsedTime() << " ms\n";
-    }
-};
-
-
-
-
 void fill(float* a, int N) {
 	for (int i = 0; i < N; ++i) a[i] = (float) rng::fromNormalDistribution(-1.0, 1.0);
 }
@@ -194,12 +168,13 @@ void transpose_oblivious2(const float* a, float* b, int rows, int cols, int lda,
 
 
 
-int main() {
+int main(int argc, char** argv) {
+
+	bench::suite suite("out-of-place", argc, argv);
 
-	int rows, cols, iter;
+	int rows, cols;
 	cout << "Rows: "; cin >> rows;
 	cout << "Columns: "; cin >> cols;
-	cout << "Iter: "; cin >> iter;
 
 	int N = rows * cols;
 
@@ -210,22 +185,14 @@ int main() {
 
 	fill(a, N);
 
-	Timer timer{};
-
-	timer.start();
-	for (volatile int i = 0; i < iter; ++i) transpose_blocked(a, b, rows, cols, cols, rows);
-	timer.stop();
-	cout << "Blocked time (ms): " << timer.elapsedTime() << "\n";
+	bench::result r = suite.run("blocked", [&]() { transpose_blocked(a, b, rows, cols, cols, rows); }, N);
+	cout << "Blocked time: " << bench::format(r) << " (" << r.median_ns * 1e-6 << " ms)\n";
 
-	timer.start();
-	for (volatile int i = 0; i < iter; ++i) transpose_oblivious2(a, c, rows, cols, cols, rows);
-	timer.stop();
-	cout << "Oblivious time (ms): " << timer.elapsedTime() << "\n";
+	r = suite.run("oblivious", [&]() { transpose_oblivious2(a, c, rows, cols, cols, rows); }, N);
+	cout << "Oblivious time: " << bench::format(r) << " (" << r.median_ns * 1e-6 << " ms)\n";
 
-	timer.start();
-	for (volatile int i = 0; i < iter; ++i) transpose_naive(a, d, rows, cols, cols, rows);
-	timer.stop();
-	cout << "Naive time (ms): " << timer.elapsedTime() << "\n";
+	r = suite.run("naive", [&]() { transpose_naive(a, d, rows, cols, cols, rows); }, N);
+	cout << "Naive time: " << bench::format(r) << " (" << r.median_ns * 1e-6 << " ms)\n";
 
 	if (cmp(b, d, N)) cout << "Certo!\n";
 	else cout << "Errado :(\n";
@@ -238,5 +205,5 @@ int main() {
 	delete[] c;
 	delete[] d;
 
-	return 0;
+	return suite.finish();
 }
\ No newline at end of file
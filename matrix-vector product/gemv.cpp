@@ -4,39 +4,13 @@
 #include <cmath>
 
 #include "../../rng.h"
+#include "../bench/bench.hpp"
 
 using namespace std;
 
 
 
 
-struct Timer {
-
-	std::chrono::high_resolution_clock::time_point start_time;
-	std::chrono::high_resolution_clock::time_point end_time;
-
-
-	void start() {
-		start_time = std::chrono::high_resolution_clock::now();
-	}
-
-	void stop() {
-		end_time = std::chrono::high_resolution_clock::now();
-	}
-
-
-	double elapsedTime() const {
-		return std::chrono::duration<double, std::milli>(end_time - start_time).count();
-	}
-
-	void displayTime() const {
-		std::cout << "Elapsed time: " << elapsedTime() << " ms\n";
-	}
-};
-
-
-
-
 float* alloc(int n) {
 	return new (std::align_val_t(32)) float[n]();
 }
@@ -180,7 +154,9 @@ void gemv_blocked(const float* a, const float* b, float* c, int rows, int cols,
 }
 
 
-int main() {
+int main(int argc, char** argv) {
+
+	bench::suite suite("gemv", argc, argv);
 
 	int rows = 1024, cols = 500000;
 	// cout << "Number of rows: "; cin >> rows;
@@ -198,28 +174,20 @@ int main() {
 	fill(b, cols);
 
 
-	Timer timer{};
-
-
-	timer.start();
-	gemv_naive(a, b, c1, rows, cols, cols);
-	timer.stop();
-	cout << "Naive: " << timer.elapsedTime() << "\n";
-
-	timer.start();
-	gemv_SIMD(a, b, c2, rows, cols, cols);
-	timer.stop();
-	cout << "SIMD: " << timer.elapsedTime() << "\n";
-
-	timer.start();
-	gemv_kernel(a, b, c3, rows, cols, cols);
-	timer.stop();
-	cout << "Kernel: " << timer.elapsedTime() << "\n";
+	// they all do c += a * b, so c starts from 0 every call (1024 floats, nothing next to the
+	// 2 GB of a), and the check at the end still works
+	auto report = [&](const char* name, auto gemv, float* c) {
+		bench::result r = suite.run(name, [&]() {
+			std::fill(c, c + rows, 0.0f);
+			gemv(a, b, c, rows, cols, cols);
+		}, static_cast<double>(rows) * cols);
+		cout << name << ": " << r.median_ns * 1e-6 << " ms (" << bench::format(r) << ")\n";
+	};
 
-	timer.start();
-	gemv_blocked(a, b, c4, rows, cols, cols);
-	timer.stop();
-	cout << "Blocked: " << timer.elapsedTime() << "\n";
+	report("Naive", gemv_naive, c1);
+	report("SIMD", gemv_SIMD, c2);
+	report("Kernel", gemv_kernel, c3);
+	report("Blocked", gemv_blocked, c4);
 
 
 	if (cmp(c1, c2, rows)) cout << "Certo!\n";
@@ -236,5 +204,5 @@ int main() {
 	dealloc(c3);
 	dealloc(c4);
 
-	return 0;
+	return suite.finish();
 }